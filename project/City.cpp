@@ -1,7 +1,7 @@
 
 #include "City.h"
 
-std::string City::getName() const {
+const std::string& City::getName() const {
     return name;
 }
 
@@ -17,7 +17,7 @@ int City::getID() const {
     return id;
 }
 
-std::string City::getCode() const{
+const std::string& City::getCode() const{
     return code;
 }
 
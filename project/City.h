@@ -32,7 +32,7 @@ public:
      *
      * @return The City name.
      */
-    [[nodiscard]] std::string getName() const;
+    [[nodiscard]] const std::string& getName() const;
     /**
      * \brief Gets the City demand.
      *
@@ -56,7 +56,7 @@ public:
      *
      * @return The City code.
      */
-    [[nodiscard]] std::string getCode() const;
+    [[nodiscard]] const std::string& getCode() const;
     /**
      * \brief Less than operator to compare City IDs.
      *
@@ -0,0 +1,384 @@
+#include "Contingency.h"
+#include <atomic>
+#include <thread>
+#include <random>
+#include <set>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+Contingency::Contingency(WaterSupply& waterSupply): waterSupply(waterSupply) {}
+
+void Contingency::setThreads(unsigned threads) {
+    this->threads = threads;
+}
+
+unsigned Contingency::getThreads() const {
+    return std::max(1u, threads != 0 ? threads : std::thread::hardware_concurrency());
+}
+
+/********************** Outages  ****************************/
+
+Outage vertexOutage(Graph* network, unsigned id, double failureProbability) {
+    Vertex* v = network->findVertex(id);
+    Outage outage{v->getInfo(), {}, {id}, failureProbability};
+    for (Edge* e: v->getAdj()) outage.edges.push_back(e->getId());
+    for (Edge* e: v->getIncoming()) outage.edges.push_back(e->getId());
+    return outage;
+}
+
+vector<Outage> Contingency::reservoirOutages() {
+    Graph* network = waterSupply.getNetwork();
+    network->getFlowGraph();  // assigns the Edge IDs
+    vector<Outage> outages;
+    for (unsigned id: waterSupply.getReservoirIds()) {
+        if (!network->findVertex(id)->checkActive()) continue;
+        outages.push_back(vertexOutage(network, id, waterSupply.getReservoir(id).getFailureProbability()));
+    }
+    return outages;
+}
+
+vector<Outage> Contingency::stationOutages() {
+    Graph* network = waterSupply.getNetwork();
+    network->getFlowGraph();
+    vector<Outage> outages;
+    for (unsigned id: waterSupply.getStationIds()) {
+        if (!network->findVertex(id)->checkActive()) continue;
+        const Station& station = waterSupply.getStations().at(network->getInfo(id));
+        outages.push_back(vertexOutage(network, id, station.getFailureProbability()));
+    }
+    return outages;
+}
+
+vector<Outage> Contingency::pipeOutages() {
+    Graph* network = waterSupply.getNetwork();
+    network->getFlowGraph();
+    unsigned src = waterSupply.getVertexId("src");
+    vector<Outage> outages;
+    for (auto v: network->getVertexSet()) {
+        if (v->getInfo().substr(0,1) == "C" || v->getId() == src) continue;
+        for (auto e: v->getAdj()) {
+            if (!e->checkActive()) continue;
+            if ((e->getReverse() != nullptr) && e->getOrig()->getInfo() < e->getDest()->getInfo()) continue;
+            Outage outage{e->getOrig()->getInfo() + " - " + e->getDest()->getInfo(), {e->getId()}, {},
+                          waterSupply.getPipeFailureProbability(e->getOrig()->getInfo(), e->getDest()->getInfo())};
+            if (e->getReverse() != nullptr) outage.edges.push_back(e->getReverse()->getId());
+            outages.push_back(outage);
+        }
+    }
+    return outages;
+}
+
+/********************** Evaluation  ****************************/
+
+/**
+ * \brief The max flow of the intact network the outages are evaluated against.
+ */
+struct Baseline {
+    const SolverWorkspace& base;  // holds the max flow of the intact network
+    unsigned src, snk;
+    MaxFlowEngine engine;
+    const vector<unsigned>& cityIds;
+    vector<unsigned> cityEdges;   // Edge ID from each City to the sink
+};
+
+Baseline makeBaseline(WaterSupply& waterSupply) {
+    Graph* network = waterSupply.getNetwork();
+    unsigned snk = waterSupply.getVertexId("sink");
+    Baseline baseline{waterSupply.getWorkspace(), waterSupply.getVertexId("src"), snk, waterSupply.getEngine(),
+                      waterSupply.getCityIds(), {}};
+    for (unsigned id: baseline.cityIds) baseline.cityEdges.push_back(network->findEdge(id, snk)->getId());
+    return baseline;
+}
+
+OutageResult applyOutage(SolverWorkspace& ws, const Baseline& b, const Outage& outage) {
+    // leaves the flow of the outage in ws and restores its active state
+    OutageResult result;
+    for (unsigned e: outage.edges) ws.edgeActive[e] = false;
+    for (unsigned v: outage.vertices) ws.vertexActive[v] = false;
+    ws.flow = b.base.flow;
+    if (!MaxFlow::isCutNeutral(b.src, b.snk, ws, outage.edges)) {
+        ws.flow = b.base.flow;
+        MaxFlow::removeCut(b.src, b.snk, ws, outage.edges, b.engine);
+        result.solved = true;
+        for (unsigned c = 0; c < b.cityIds.size(); c++) {
+            double flow = ws.flow[b.cityEdges[c]];
+            double delta = flow - b.base.flow[b.cityEdges[c]];
+            if (delta == 0) continue;
+            result.affected.push_back({b.cityIds[c], flow, delta});
+            result.deficit -= delta;
+        }
+    }
+    for (unsigned e: outage.edges) ws.edgeActive[e] = b.base.edgeActive[e];
+    for (unsigned v: outage.vertices) ws.vertexActive[v] = b.base.vertexActive[v];
+    return result;
+}
+
+void Contingency::runParallel(unsigned long tasks, const function<void(SolverWorkspace&, unsigned long)>& task) {
+    const SolverWorkspace& base = waterSupply.getWorkspace();
+    atomic<unsigned long> next(0);
+    auto worker = [&]() {
+        SolverWorkspace ws;
+        ws.attach(base.getGraph());
+        ws.capacity = base.capacity;
+        ws.edgeActive = base.edgeActive;
+        ws.vertexActive = base.vertexActive;
+        ws.threads = 1;  // the pool already uses every core
+        for (unsigned long i = next++; i < tasks; i = next++) task(ws, i);
+    };
+    unsigned numThreads = std::min<unsigned long>(getThreads(), std::max(tasks, 1ul));
+    vector<thread> pool;
+    for (unsigned t = 1; t < numThreads; t++) pool.emplace_back(worker);
+    worker();
+    for (thread& t: pool) t.join();
+}
+
+vector<OutageResult> Contingency::evaluate(const vector<Outage>& outages) {
+    waterSupply.maxFlow();
+    return solve(outages);
+}
+
+vector<OutageResult> Contingency::solve(const vector<Outage>& outages) {
+    Baseline baseline = makeBaseline(waterSupply);
+    vector<OutageResult> results(outages.size());
+    runParallel(outages.size(), [&](SolverWorkspace& ws, unsigned long i) {
+        results[i] = applyOutage(ws, baseline, outages[i]);
+    });
+    return results;
+}
+
+/********************** N-k enumeration  ****************************/
+
+void Contingency::setSampleLimit(unsigned long sampleLimit) {
+    this->sampleLimit = std::max(1ul, sampleLimit);
+}
+
+void Contingency::setSeed(unsigned seed) {
+    this->seed = seed;
+}
+
+unsigned long long binomial(unsigned n, unsigned k) {
+    // saturates at the maximum value instead of overflowing
+    if (k > n) return 0;
+    unsigned long long c = 1;
+    for (unsigned i = 0; i < k; i++) {
+        if (c > std::numeric_limits<unsigned long long>::max() / (n - i)) return std::numeric_limits<unsigned long long>::max();
+        c = c * (n - i) / (i + 1);
+    }
+    return c;
+}
+
+bool nextCombination(vector<unsigned>& comb, unsigned n) {
+    unsigned k = comb.size();
+    unsigned i = k;
+    while (i > 0 && comb[i - 1] == n - k + i - 1) i--;
+    if (i == 0) return false;
+    comb[i - 1]++;
+    for (unsigned j = i; j < k; j++) comb[j] = comb[j - 1] + 1;
+    return true;
+}
+
+bool isDominated(const vector<unsigned>& comb, const set<vector<unsigned>>& critical) {
+    // checks every proper subset of the combination, so k must stay small
+    unsigned k = comb.size();
+    vector<unsigned> subset;
+    for (unsigned long mask = 1; mask + 1 < (1ul << k); mask++) {
+        subset.clear();
+        for (unsigned i = 0; i < k; i++) {
+            if (mask & (1ul << i)) subset.push_back(comb[i]);
+        }
+        if (critical.count(subset)) return true;
+    }
+    return false;
+}
+
+vector<NkLevel> Contingency::enumerate(const vector<Outage>& components, unsigned k, ostream& out) {
+    static constexpr unsigned CHUNK = 1024;  // combinations evaluated in parallel before their rows are written
+    waterSupply.maxFlow();
+    const vector<double>& baseFlow = waterSupply.getWorkspace().flow;
+    unsigned n = components.size();
+    vector<double> throughFlow(n, 0);
+    for (unsigned i = 0; i < n; i++) {
+        for (unsigned e: components[i].edges) throughFlow[i] += baseFlow[e];
+    }
+
+    out << "Components,Deficit,Affected Cities\n";
+    set<vector<unsigned>> critical;
+    vector<NkLevel> levels;
+    mt19937 rng(seed);
+    vector<vector<unsigned>> batch;
+    vector<Outage> outages;
+
+    for (unsigned size = 1; size <= std::min(k, n); size++) {
+        // a component that is critical alone dominates every combination with it, so only the others are combined
+        vector<unsigned> pool;
+        for (unsigned i = 0; i < n; i++) {
+            if (!critical.count({i})) pool.push_back(i);
+        }
+        NkLevel level;
+        level.size = size;
+        level.combinations = binomial(n, size);
+        unsigned long long candidates = binomial(pool.size(), size);
+        level.dominated = level.combinations - candidates;
+        level.sampled = candidates > sampleLimit;
+
+        auto flush = [&]() {
+            vector<OutageResult> results = solve(outages);
+            for (unsigned i = 0; i < outages.size(); i++) {
+                level.evaluated++;
+                if (results[i].deficit > 0) {
+                    level.critical++;
+                    critical.insert(batch[i]);
+                }
+                out << outages[i].name << ',' << results[i].deficit << ',';
+                for (unsigned c = 0; c < results[i].affected.size(); c++) {
+                    const AffectedCity& affected = results[i].affected[c];
+                    out << (c ? " | " : "") << waterSupply.getCity(affected.city).getCode() << ' ' << affected.delta;
+                }
+                out << '\n';
+            }
+            out.flush();
+            batch.clear();
+            outages.clear();
+        };
+        auto visit = [&](vector<unsigned> comb) {
+            for (unsigned& i: comb) i = pool[i];
+            if (isDominated(comb, critical)) {
+                level.dominated++;
+                return;
+            }
+            double total = 0;
+            for (unsigned i: comb) total += throughFlow[i];
+            if (total == 0) {
+                level.idle++;
+                return;
+            }
+            Outage outage;
+            for (unsigned i: comb) {
+                outage.name += (outage.name.empty() ? "" : " + ") + components[i].name;
+                outage.edges.insert(outage.edges.end(), components[i].edges.begin(), components[i].edges.end());
+                outage.vertices.insert(outage.vertices.end(), components[i].vertices.begin(), components[i].vertices.end());
+            }
+            batch.push_back(comb);
+            outages.push_back(outage);
+            if (outages.size() == CHUNK) flush();
+        };
+
+        if (level.sampled) {
+            set<vector<unsigned>> drawn;
+            uniform_int_distribution<unsigned> pick(0, pool.size() - 1);
+            for (unsigned long draw = 0; draw < 4 * sampleLimit && drawn.size() < sampleLimit; draw++) {
+                set<unsigned> members;
+                while (members.size() < size) members.insert(pick(rng));
+                vector<unsigned> comb(members.begin(), members.end());
+                if (drawn.insert(comb).second) visit(comb);
+            }
+        } else if (candidates > 0) {
+            vector<unsigned> comb(size);
+            for (unsigned i = 0; i < size; i++) comb[i] = i;
+            do visit(comb); while (nextCombination(comb, pool.size()));
+        }
+        if (!outages.empty()) flush();
+        levels.push_back(level);
+    }
+    return levels;
+}
+
+/********************** Monte Carlo  ****************************/
+
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+SimulationResult Contingency::simulate(const vector<Outage>& components, unsigned long samples) {
+    static constexpr unsigned long BLOCK = 1024;  // samples per task, summed in order to keep the result reproducible
+    static constexpr double Z95 = 1.959964;       // standard normal quantile of the 95% confidence interval
+    waterSupply.maxFlow();
+    Baseline baseline = makeBaseline(waterSupply);
+    vector<const Outage*> risky;
+    for (const Outage& component: components) {
+        if (component.failureProbability > 0) risky.push_back(&component);
+    }
+    unsigned numCities = baseline.cityIds.size();
+    vector<double> demand(numCities), baseUnmet(numCities);
+    for (unsigned c = 0; c < numCities; c++) {
+        demand[c] = waterSupply.getCity(baseline.cityIds[c]).getDemand();
+        baseUnmet[c] = std::max(0.0, demand[c] - baseline.base.flow[baseline.cityEdges[c]]);
+    }
+
+    struct Block {
+        vector<double> sum, sumSquares;  // unmet demand of each City, the last slot is the total of the network
+        vector<unsigned long> losses;
+        unsigned long solved = 0;
+    };
+    unsigned long numBlocks = (samples + BLOCK - 1) / BLOCK;
+    vector<Block> blocks(numBlocks);
+    runParallel(numBlocks, [&](SolverWorkspace& ws, unsigned long b) {
+        Block& block = blocks[b];
+        block.sum.assign(numCities + 1, 0);
+        block.sumSquares.assign(numCities + 1, 0);
+        block.losses.assign(numCities, 0);
+        vector<double> unmet(numCities + 1);
+        Outage outage;
+        for (unsigned long i = b * BLOCK; i < std::min(samples, (b + 1) * BLOCK); i++) {
+            // every sample has its own generator, so the failures do not depend on the thread that draws them
+            uint64_t state = ((uint64_t) seed << 32) ^ i;
+            splitMix64(state);
+            outage.edges.clear();
+            outage.vertices.clear();
+            for (const Outage* component: risky) {
+                if ((splitMix64(state) >> 11) * 0x1.0p-53 >= component->failureProbability) continue;
+                outage.edges.insert(outage.edges.end(), component->edges.begin(), component->edges.end());
+                outage.vertices.insert(outage.vertices.end(), component->vertices.begin(), component->vertices.end());
+            }
+            std::copy(baseUnmet.begin(), baseUnmet.end(), unmet.begin());
+            if (!outage.edges.empty()) {
+                OutageResult result = applyOutage(ws, baseline, outage);
+                if (result.solved) {
+                    block.solved++;
+                    for (unsigned c = 0; c < numCities; c++) {
+                        double flow = ws.flow[baseline.cityEdges[c]];
+                        if (flow < baseline.base.flow[baseline.cityEdges[c]]) block.losses[c]++;
+                        unmet[c] = std::max(0.0, demand[c] - flow);
+                    }
+                }
+            }
+            unmet[numCities] = 0;
+            for (unsigned c = 0; c < numCities; c++) unmet[numCities] += unmet[c];
+            for (unsigned c = 0; c <= numCities; c++) {
+                block.sum[c] += unmet[c];
+                block.sumSquares[c] += unmet[c] * unmet[c];
+            }
+        }
+    });
+
+    SimulationResult result;
+    result.samples = samples;
+    vector<double> sum(numCities + 1, 0), sumSquares(numCities + 1, 0);
+    vector<unsigned long> losses(numCities, 0);
+    for (const Block& block: blocks) {
+        result.solved += block.solved;
+        for (unsigned c = 0; c <= numCities; c++) {
+            sum[c] += block.sum[c];
+            sumSquares[c] += block.sumSquares[c];
+        }
+        for (unsigned c = 0; c < numCities; c++) losses[c] += block.losses[c];
+    }
+    auto interval = [&](unsigned c, double& mean, double& margin) {
+        mean = samples ? sum[c] / samples : 0;
+        double variance = samples > 1 ? std::max(0.0, (sumSquares[c] - sum[c] * mean) / (samples - 1)) : 0;
+        margin = samples ? Z95 * sqrt(variance / samples) : 0;
+    };
+    for (unsigned c = 0; c < numCities; c++) {
+        CityRisk risk{baseline.cityIds[c], 0, 0, samples ? (double) losses[c] / samples : 0};
+        interval(c, risk.expectedUnmet, risk.margin);
+        result.cities.push_back(risk);
+    }
+    interval(numCities, result.expectedUnmet, result.margin);
+    return result;
+}
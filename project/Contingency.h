@@ -0,0 +1,203 @@
+#ifndef WATERSUPPLYMANAGER_CONTINGENCY_H
+#define WATERSUPPLYMANAGER_CONTINGENCY_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include "WaterSupply.h"
+
+/**
+ * \brief A set of components of the network taken out of service together.
+ */
+struct Outage {
+    std::string name;                // codes of the components, "R_1" or "PS_3 - C_4" for a pipe
+    std::vector<unsigned> edges;     // IDs of the Edge that stop carrying water
+    std::vector<unsigned> vertices;  // IDs of the Vertex taken out of service
+    double failureProbability = 0;   // chance of the components being out of service, -1 if not given
+};
+
+/**
+ * \brief The flow of a City that an Outage changes.
+ */
+struct AffectedCity {
+    unsigned city;  // Vertex ID of the City
+    double flow;    // flow of the City during the outage
+    double delta;   // flow during the outage - flow without it
+};
+
+/**
+ * \brief The effect of an Outage on the Cities.
+ */
+struct OutageResult {
+    std::vector<AffectedCity> affected;
+    double deficit = 0;   // water the Cities lose in total
+    bool solved = false;  // false if the outage was shown to change no City without solving it
+};
+
+/**
+ * \brief The combined outages of one size evaluated by an N-k enumeration.
+ */
+struct NkLevel {
+    unsigned size = 0;                   // number of components failing together
+    unsigned long long combinations = 0; // number of combinations of that size, saturated at the maximum value
+    bool sampled = false;                // true if random combinations were drawn instead of all the candidates
+    unsigned long evaluated = 0;         // combinations evaluated
+    unsigned long critical = 0;          // evaluated combinations that leave the Cities with less water
+    unsigned long long dominated = 0;    // combinations skipped because a smaller critical combination is part of them
+    unsigned long idle = 0;              // combinations skipped because none of their components carried flow
+};
+
+/**
+ * \brief The unmet demand of a City over the samples of a Monte Carlo simulation.
+ */
+struct CityRisk {
+    unsigned city;           // Vertex ID of the City
+    double expectedUnmet;    // mean of demand - flow over the samples
+    double margin;           // half width of the 95% confidence interval of expectedUnmet
+    double lossProbability;  // fraction of the samples in which the City got less water than without failures
+};
+
+/**
+ * \brief The result of a Monte Carlo simulation of random outages.
+ */
+struct SimulationResult {
+    unsigned long samples = 0;
+    unsigned long solved = 0;  // samples whose outages changed some City and had to be repaired
+    double expectedUnmet = 0;  // mean of the unmet demand of the whole network
+    double margin = 0;         // half width of the 95% confidence interval of expectedUnmet
+    std::vector<CityRisk> cities;
+};
+
+/**
+ * \class Contingency
+ * \brief Evaluates outages of reservoirs, stations and pipes against the max flow of a WaterSupply.
+ *
+ * The outages are spread over a pool of threads. Every worker owns a SolverWorkspace over the shared FlowGraph and
+ * starts each outage from the max flow of the intact network, so the Graph is never modified while they run.
+ */
+class Contingency {
+private:
+    WaterSupply& waterSupply;
+    unsigned threads = 0;
+    unsigned long sampleLimit = 20000;
+    unsigned seed = 0;
+    /**
+     * \brief Evaluates the given outages against the max flow held by the workspace of the WaterSupply.
+     *
+     * @param outages The outages to evaluate.
+     * @return The effect of each Outage, in the same order.
+     */
+    std::vector<OutageResult> solve(const std::vector<Outage>& outages);
+    /**
+     * \brief Runs the given task for every index in [0, tasks) on the thread pool. Each thread owns a SolverWorkspace
+     * with the capacities and active state held by the workspace of the WaterSupply.
+     *
+     * @param tasks The number of tasks.
+     * @param task The task, called with the workspace of its thread and its index.
+     */
+    void runParallel(unsigned long tasks, const std::function<void(SolverWorkspace&, unsigned long)>& task);
+public:
+    /**
+     * \brief Contingency constructor.
+     *
+     * @param waterSupply The WaterSupply whose network is evaluated.
+     */
+    explicit Contingency(WaterSupply& waterSupply);
+    /**
+     * \brief Sets the number of threads used by evaluate().
+     *
+     * @param threads The number of threads, 0 for one per core.
+     */
+    void setThreads(unsigned threads);
+    /**
+     * \brief Gets the number of threads used by evaluate().
+     *
+     * @return The number of threads.
+     */
+    unsigned getThreads() const;
+    /**
+     * \brief Builds one Outage for each active Reservoir.
+     *
+     * @return The Reservoir outages, ordered by Reservoir ID.
+     */
+    std::vector<Outage> reservoirOutages();
+    /**
+     * \brief Builds one Outage for each active Station.
+     *
+     * @return The Station outages, ordered by Station ID.
+     */
+    std::vector<Outage> stationOutages();
+    /**
+     * \brief Builds one Outage for each active pipe, a bidirectional pipe failing in both directions at once.
+     *
+     * @return The pipe outages.
+     */
+    std::vector<Outage> pipeOutages();
+    /**
+     * \brief Computes the max flow of the intact network and the effect of every given Outage on it.
+     *
+     * An Outage whose flow can be rerouted without changing any City is not solved; the others cancel the flow that
+     * crossed the components and augment again with the WaterSupply's engine.
+     *
+     * @param outages The outages to evaluate.
+     * @return The effect of each Outage, in the same order.
+     *
+     * \par Complexity
+     * O(N(V + E + A) / T) in which N is the number of outages, V the number of vertex, E the number of edges of the
+     * Graph, A the cost of repairing one outage and T the number of threads.
+     */
+    std::vector<OutageResult> evaluate(const std::vector<Outage>& outages);
+    /**
+     * \brief Sets the number of combinations of each size above which enumerate() samples them instead.
+     *
+     * @param sampleLimit The largest number of combinations evaluated for each size.
+     */
+    void setSampleLimit(unsigned long sampleLimit);
+    /**
+     * \brief Sets the seed of the random combinations drawn by enumerate() and of the failures drawn by simulate().
+     *
+     * @param seed The seed.
+     */
+    void setSeed(unsigned seed);
+    /**
+     * \brief Estimates the unmet demand of every City when each component fails independently with its failure
+     * probability.
+     *
+     * Every sample draws the failing components, starts from the max flow of the intact network and repairs it like
+     * evaluate(). Sample i always draws the same failures for the same seed and the samples are summed in fixed
+     * blocks, so the result does not depend on the number of threads.
+     *
+     * @param components The outages of the single components, with their failure probabilities; the negative ones
+     * never fail.
+     * @param samples The number of samples.
+     * @return The expected unmet demand of each City and of the network, with 95% confidence intervals.
+     *
+     * \par Complexity
+     * O(S (R + A) / T) in which S is the number of samples, R the number of components that can fail, A the cost of
+     * repairing one sample and T the number of threads.
+     */
+    SimulationResult simulate(const std::vector<Outage>& components, unsigned long samples);
+    /**
+     * \brief Evaluates the outages of every combination of up to k of the given components, from the smallest
+     * combinations to the largest.
+     *
+     * A combination is skipped if a smaller critical combination, i.e. one that leaves the Cities with less water, is
+     * part of it, or if none of its components carries flow. Sizes with more candidate combinations than the sample
+     * limit are evaluated on at most that many distinct random candidates. Every evaluated combination is written to out as a CSV row
+     * as soon as its chunk is solved.
+     *
+     * @param components The outages of the single components.
+     * @param k The largest number of components failing together. Every proper subset of a combination is checked
+     * for dominance, so k should stay small.
+     * @param out The stream the results are written to.
+     * @return The counts of each combination size.
+     *
+     * \par Complexity
+     * O(C 2^k log C + C A / T) in which C is the number of combinations visited, A the cost of evaluating one
+     * outage and T the number of threads.
+     */
+    std::vector<NkLevel> enumerate(const std::vector<Outage>& components, unsigned k, std::ostream& out);
+};
+
+#endif //WATERSUPPLYMANAGER_CONTINGENCY_H
@@ -1,283 +1,1065 @@
 #include "MaxFlow.h"
-#include "datastructures/MutablePriorityQueue.h"
-#include <queue>
+#include "datastructures/IndexedHeap.h"
 #include <stack>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "datastructures/Barrier.h"
 using namespace std;
 
 
 /********************** Max Flow  ****************************/
 
-double residualC(Edge* e, bool out){
-    return out ? e->getWeight() - e->getFlow() : e->getFlow();
+double residualC(const SolverWorkspace& ws, unsigned a, bool reverse){
+    if (!reverse) return ws.residual(a);
+    const FlowGraph& g = ws.getGraph();
+    unsigned e = g.edgeOf(a);
+    return g.isForward(a) ? ws.flow[e] : ws.capacity[e] - ws.flow[e];
 }
 
-double getCf(Vertex* source, Vertex* target) {
+double getCf(const SolverWorkspace& ws, unsigned source, unsigned target, bool reverse = false) {
+    const FlowGraph& g = ws.getGraph();
     double minC = INF;
-    Vertex *curr = target;
-    while (curr != source) {
-        bool outgoing = curr->getPath()->getDest() == curr;
-        minC = std::min(minC, residualC(curr->getPath(), outgoing));
-        curr = outgoing ? curr->getPath()->getOrig() : curr->getPath()->getDest();
+    for (unsigned curr = target; curr != source; curr = g.tail(ws.path[curr])) {
+        minC = std::min(minC, residualC(ws, ws.path[curr], reverse));
     }
     return minC;
 }
 
-void augmentPath(Vertex* source, Vertex* target, double cf) {
-    Vertex* curr = target;
-    while (curr != source){
-        bool outgoing = curr->getPath()->getDest() == curr;
-        curr->getPath()->setFlow(outgoing ? curr->getPath()->getFlow() + cf : curr->getPath()->getFlow() - cf);
-        curr = outgoing ? curr->getPath()->getOrig() : curr->getPath()->getDest();
+void augmentPath(SolverWorkspace& ws, unsigned source, unsigned target, double cf) {
+    const FlowGraph& g = ws.getGraph();
+    for (unsigned curr = target; curr != source; curr = g.tail(ws.path[curr])) {
+        ws.push(ws.path[curr], cf);
     }
 }
 
-void testAndVisit(queue<Vertex*>& q, Edge* e, Vertex* w, double residual) {
-    if (!w->isVisited() && residual > 0 && w->checkActive() && e->checkActive()) {
-        w->setVisited(true);
-        w->setPath(e);
-        q.push(w);
+bool findAugPath(SolverWorkspace& ws, unsigned src, unsigned target, bool reverse = false, double delta = 0){
+    const FlowGraph& g = ws.getGraph();
+    unsigned* queue = ws.frontier.data();
+    unsigned head = 0, tail = 0;
+    ws.newSearch();
+    queue[tail++] = src;
+    ws.label(src);
+    while(head < tail){
+        unsigned v = queue[head++];
+        for(unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++){
+            unsigned w = g.head(a);
+            double r = residualC(ws, a, reverse);
+            if (!ws.isLabeled(w) && r > 0 && r >= delta && ws.isUsable(a)) {
+                ws.label(w);
+                ws.path[w] = a;
+                if (w == target) return true;
+                queue[tail++] = w;
+            }
+        }
+    }
+    return false;
+}
+
+void MaxFlow::maxFlow(const string& source, const string& sink, Graph* network, SolverWorkspace& ws) {
+    maxFlow(network->findVertexId(source), network->findVertexId(sink), network, ws);
+}
+
+void MaxFlow::run(unsigned src, unsigned snk, SolverWorkspace& ws, MaxFlowEngine engine) {
+    switch (engine) {
+        case MaxFlowEngine::EDMONDS_KARP:
+            while(findAugPath(ws, src, snk)){
+                double cf = getCf(ws, src, snk);
+                augmentPath(ws, src, snk, cf);
+            }
+            break;
+        case MaxFlowEngine::DINIC:
+            MaxFlow::dinic(src, snk, ws);
+            break;
+        case MaxFlowEngine::PUSH_RELABEL:
+            MaxFlow::pushRelabel(src, snk, ws);
+            break;
+        case MaxFlowEngine::PARALLEL_PUSH_RELABEL:
+            MaxFlow::parallelPushRelabel(src, snk, ws);
+            break;
+        case MaxFlowEngine::CAPACITY_SCALING:
+            MaxFlow::capacityScaling(src, snk, ws);
+            break;
+        case MaxFlowEngine::BOYKOV_KOLMOGOROV:
+            MaxFlow::boykovKolmogorov(src, snk, ws);
+            break;
+    }
+}
+
+void MaxFlow::maxFlow(unsigned src, unsigned snk, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
+    ws.attach(*network->getFlowGraph());
+    ws.load();
+    run(src, snk, ws, engine);
+    ws.store();
+}
+
+/********************** Warm start  ****************************/
+
+bool moveExcess(SolverWorkspace& ws, unsigned from, unsigned to, double& amount) {
+    while (amount > 0 && findAugPath(ws, from, to)) {
+        double cf = std::min(amount, getCf(ws, from, to));
+        augmentPath(ws, from, to, cf);
+        amount -= cf;
     }
+    return amount <= 0;
 }
 
-bool findAugPath(Graph* g, Vertex* src, Vertex* target){
-    for(auto v : g->getVertexSet())
-        v.second->setVisited(false); //reset
-    std::queue<Vertex*> aux;
-    aux.push(src);
-    src->setVisited(true);
-    while(!aux.empty() && !target->isVisited()){
-        Vertex* v = aux.front();
-        aux.pop();
-        for(Edge* adj : v->getAdj()){
-            testAndVisit(aux, adj, adj->getDest(), residualC(adj, true));
+void MaxFlow::reSolve(unsigned src, unsigned snk, Graph* network, SolverWorkspace& ws,
+                      const vector<CapacityDelta>& deltas, MaxFlowEngine engine) {
+    for (const CapacityDelta& d: deltas) {
+        d.edge->setWeight(std::max(0.0, std::min(d.edge->getWeight() + d.delta, INF)));
+    }
+    ws.attach(*network->getFlowGraph());
+    ws.load();
+    const FlowGraph& g = ws.getGraph();
+    bool repaired = true;
+    for (const CapacityDelta& d: deltas) {
+        unsigned e = d.edge->getId();
+        double over = ws.flow[e] - ws.capacity[e];
+        if (over <= 0) continue;
+        ws.flow[e] = ws.capacity[e];
+        // the origin now has a surplus and the destination a deficit; route one to the other around the edge when
+        // possible, so the flow value is kept, and give the rest back to the source and take it from the sink
+        unsigned u = g.getOrig(e), v = g.getDest(e);
+        moveExcess(ws, u, v, over);
+        double deficit = over;
+        if (u != src) repaired &= moveExcess(ws, u, src, over);
+        if (v != snk) repaired &= moveExcess(ws, snk, v, deficit);
+    }
+    if (!repaired) std::fill(ws.flow.begin(), ws.flow.end(), 0);  // inconsistent previous flow, solve from scratch
+    run(src, snk, ws, engine);
+    ws.store();
+}
+
+/********************** Prioritized allocation  ****************************/
+
+unsigned MaxFlow::prioritizedMaxFlow(unsigned src, unsigned snk, SolverWorkspace& ws, const vector<unsigned>& targets,
+                                     MaxFlowEngine engine) {
+    // the vertices reachable from src in the residual network only shrink while flow is augmented from src, so the
+    // vertices a failed search could not reach are switched off for the following searches
+    const FlowGraph& g = ws.getGraph();
+    vector<unsigned> pruned;
+    unsigned searches = 0;
+    bool sinkActive = ws.vertexActive[snk];
+    ws.vertexActive[snk] = false;  // the sink is never crossed, so the flow of a target is never given to another
+    for (unsigned e: targets) {
+        unsigned target = g.getOrig(e);
+        while (ws.vertexActive[target] && ws.edgeActive[e] && ws.flow[e] < ws.capacity[e]) {
+            searches++;
+            if (!findAugPath(ws, src, target)) {
+                for (unsigned v = 0; v < g.getNumVertex(); v++) {
+                    if (ws.isLabeled(v) || !ws.vertexActive[v]) continue;
+                    ws.vertexActive[v] = false;
+                    pruned.push_back(v);
+                }
+                break;
+            }
+            double cf = std::min(getCf(ws, src, target), ws.capacity[e] - ws.flow[e]);
+            augmentPath(ws, src, target, cf);
+            ws.flow[e] += cf;
         }
-        for(Edge* adj : v->getIncoming()){
-            testAndVisit(aux, adj, adj->getOrig(), residualC(adj, false));
+    }
+    for (unsigned v: pruned) ws.vertexActive[v] = true;
+    ws.vertexActive[snk] = sinkActive;
+    run(src, snk, ws, engine);  // augmenting to the sink never takes flow from the sink edges of the targets
+    return searches;
+}
+
+void MaxFlow::prioritizedMaxFlow(unsigned src, unsigned snk, Graph* network, SolverWorkspace& ws,
+                                 const vector<Edge*>& targets, MaxFlowEngine engine) {
+    ws.attach(*network->getFlowGraph());
+    ws.load();
+    vector<unsigned> ids;
+    for (Edge* e: targets) ids.push_back(e->getId());
+    prioritizedMaxFlow(src, snk, ws, ids, engine);
+    ws.store();
+}
+
+/********************** Capacity scaling  ****************************/
+
+void MaxFlow::capacityScaling(unsigned src, unsigned snk, SolverWorkspace& ws) {
+    const FlowGraph& g = ws.getGraph();
+    double maxCapacity = 0;  // unbounded (INF) edges never limit a path, so they do not set the first threshold
+    for (unsigned e = 0; e < g.getNumEdge(); e++) {
+        if (ws.edgeActive[e] && ws.capacity[e] < INF) maxCapacity = std::max(maxCapacity, ws.capacity[e]);
+    }
+    double delta = 1;
+    while (delta * 2 <= maxCapacity) delta *= 2;
+    for (; delta >= 1; delta /= 2) {
+        while (findAugPath(ws, src, snk, false, delta)) {
+            double cf = getCf(ws, src, snk);
+            augmentPath(ws, src, snk, cf);
         }
     }
-    return target->isVisited();
+    // last phase with any residual arc, so capacities that are not integers are also saturated
+    while (findAugPath(ws, src, snk)) {
+        double cf = getCf(ws, src, snk);
+        augmentPath(ws, src, snk, cf);
+    }
+}
+
+/********************** Boykov-Kolmogorov  ****************************/
+
+/*
+ * The link of a tree vertex is the Edge to its parent, stored as (edge ID << 1) | 1 if the Edge goes from the vertex
+ * up to its parent. The source tree only keeps links with residual capacity from the parent down to the vertex and
+ * the sink tree links with residual capacity from the vertex up to the parent, so every tree vertex has a residual
+ * path from the source or to the sink.
+ */
+
+static constexpr unsigned ORPHAN = SolverWorkspace::NONE - 1;  // link of a tree vertex that lost its parent
+
+unsigned treeLink(const FlowGraph& g, unsigned a, bool up) {
+    return (g.edgeOf(a) << 1) | (g.isForward(a) == up ? 1 : 0);
+}
+
+unsigned linkParent(const FlowGraph& g, unsigned link) {
+    return link & 1 ? g.getDest(link >> 1) : g.getOrig(link >> 1);
 }
 
-void MaxFlow::maxFlow(const string& source, const string& sink, Graph* network) {
-    Vertex* src = network->findVertex(source);
-    Vertex* snk = network->findVertex(sink);
-    while(findAugPath(network, src, snk)){
-        double cf = getCf(src, snk);
-        augmentPath(src, snk, cf);
+unsigned linkChild(const FlowGraph& g, unsigned link) {
+    return link & 1 ? g.getOrig(link >> 1) : g.getDest(link >> 1);
+}
+
+double treeResidual(const SolverWorkspace& ws, char side, unsigned link) {
+    unsigned e = link >> 1;
+    bool down = side == SolverWorkspace::SOURCE_TREE;
+    return (link & 1) != down ? ws.capacity[e] - ws.flow[e] : ws.flow[e];
+}
+
+bool isLinkValid(const SolverWorkspace& ws, unsigned v, unsigned link) {
+    const FlowGraph& g = ws.getGraph();
+    if (link >> 1 >= g.getNumEdge() || linkChild(g, link) != v) return false;
+    unsigned p = linkParent(g, link);
+    return ws.tree[p] == ws.tree[v] && ws.edgeActive[link >> 1] && ws.vertexActive[p]
+           && treeResidual(ws, ws.tree[v], link) > 0;
+}
+
+bool isRooted(SolverWorkspace& ws, unsigned v) {
+    // the roots and the vertices already found rooted since the last newSearch() are labeled
+    const FlowGraph& g = ws.getGraph();
+    unsigned u = v;
+    while (!ws.isLabeled(u)) {
+        if (ws.treeParent[u] == ORPHAN) return false;
+        u = linkParent(g, ws.treeParent[u]);
     }
+    for (u = v; !ws.isLabeled(u); u = linkParent(g, ws.treeParent[u])) ws.label(u);
+    return true;
 }
 
-/********************** MaxFlow Reverse  ****************************/
+void MaxFlow::boykovKolmogorov(unsigned src, unsigned snk, SolverWorkspace& ws) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned n = g.getNumVertex();
+    unsigned* active = ws.active.data();
+    unsigned activeHead = 0, activeSize = 0;
+    unsigned* orphans = ws.frontier.data();
+    unsigned orphanHead = 0, orphanSize = 0;
+    std::fill(ws.visited.begin(), ws.visited.end(), false);
+    auto activate = [&](unsigned v) {
+        if (ws.visited[v]) return;
+        ws.visited[v] = true;
+        active[(activeHead + activeSize++) % n] = v;
+    };
+    auto makeOrphan = [&](unsigned v) {
+        ws.treeParent[v] = ORPHAN;
+        orphans[(orphanHead + orphanSize++) % n] = v;
+    };
 
-bool reverseFindAugPath(Graph* g, Vertex* src, Vertex* target){
-    for(auto v : g->getVertexSet())
-        v.second->setVisited(false); //reset
-    std::queue<Vertex*> aux;
-    aux.push(src);
-    src->setVisited(true);
-    while(!aux.empty() && !target->isVisited()){
-        Vertex* v = aux.front();
-        aux.pop();
-        for(Edge* adj : v->getAdj()){
-            testAndVisit(aux, adj, adj->getDest(), residualC(adj, false));
+    // keep the trees of the last run, cutting the links the new capacities, flows or deactivations broke
+    if (!ws.treesValid) std::fill(ws.tree.begin(), ws.tree.end(), SolverWorkspace::FREE);
+    for (unsigned v = 0; v < n; v++) {
+        if (!ws.vertexActive[v]) ws.tree[v] = SolverWorkspace::FREE;
+    }
+    ws.tree[src] = SolverWorkspace::SOURCE_TREE;
+    ws.tree[snk] = SolverWorkspace::SINK_TREE;
+    ws.treeParent[src] = ws.treeParent[snk] = SolverWorkspace::NONE;
+    for (unsigned v = 0; v < n; v++) {
+        if (ws.tree[v] == SolverWorkspace::FREE || v == src || v == snk) continue;
+        if (!isLinkValid(ws, v, ws.treeParent[v])) makeOrphan(v);
+    }
+    // links that are each valid can still close a cycle when the trees came from another Graph
+    ws.newSearch();
+    ws.label(src);
+    ws.label(snk);
+    std::fill(ws.processing.begin(), ws.processing.end(), false);
+    for (unsigned v = 0; v < n; v++) {
+        if (ws.tree[v] == SolverWorkspace::FREE || ws.isLabeled(v)) continue;
+        unsigned u = v;
+        while (!ws.isLabeled(u) && !ws.processing[u] && ws.treeParent[u] != ORPHAN) {
+            ws.processing[u] = true;
+            u = linkParent(g, ws.treeParent[u]);
+        }
+        bool rooted = ws.isLabeled(u);
+        if (ws.processing[u]) makeOrphan(u);
+        for (u = v; ws.processing[u]; ) {
+            ws.processing[u] = false;
+            if (rooted) ws.label(u);
+            if (ws.treeParent[u] == ORPHAN) break;
+            u = linkParent(g, ws.treeParent[u]);
+        }
+    }
+    for (unsigned v = 0; v < n; v++) {
+        if (ws.tree[v] != SolverWorkspace::FREE) activate(v);
+    }
+
+    auto adoptOrphans = [&]() {
+        ws.newSearch();
+        ws.label(src);
+        ws.label(snk);
+        while (orphanSize > 0) {
+            unsigned v = orphans[orphanHead];
+            orphanHead = (orphanHead + 1) % n;
+            orphanSize--;
+            char side = ws.tree[v];
+            for (unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++) {
+                unsigned link = treeLink(g, a, true);
+                if (ws.tree[g.head(a)] != side || !ws.isUsable(a) || treeResidual(ws, side, link) <= 0) continue;
+                if (isRooted(ws, g.head(a))) {
+                    ws.treeParent[v] = link;
+                    break;
+                }
+            }
+            if (ws.treeParent[v] != ORPHAN) continue;
+            // no new parent: the vertex leaves its tree, its children become orphans and its neighbours may regrow it
+            for (unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++) {
+                unsigned u = g.head(a);
+                if (ws.tree[u] != side) continue;
+                unsigned link = ws.treeParent[u];
+                if (u != src && u != snk && link != ORPHAN && linkParent(g, link) == v) makeOrphan(u);
+                else if (ws.isUsable(a) && treeResidual(ws, side, treeLink(g, a, true)) > 0) activate(u);
+            }
+            ws.tree[v] = SolverWorkspace::FREE;
+        }
+    };
+    adoptOrphans();
+
+    while (true) {
+        // grow both trees until they touch through the arc a
+        unsigned a = SolverWorkspace::NONE;
+        while (activeSize > 0 && a == SolverWorkspace::NONE) {
+            unsigned p = active[activeHead];
+            if (ws.tree[p] != SolverWorkspace::FREE) {
+                for (unsigned b = g.arcBegin(p); b < g.arcEnd(p); b++) {
+                    unsigned q = g.head(b);
+                    unsigned link = treeLink(g, b, false);
+                    if (!ws.isUsable(b) || treeResidual(ws, ws.tree[p], link) <= 0) continue;
+                    if (ws.tree[q] == SolverWorkspace::FREE) {
+                        ws.tree[q] = ws.tree[p];
+                        ws.treeParent[q] = link;
+                        activate(q);
+                    }
+                    else if (ws.tree[q] != ws.tree[p]) {
+                        a = b;
+                        break;
+                    }
+                }
+            }
+            if (a == SolverWorkspace::NONE) {
+                // every arc of p was scanned, it stays out of the queue until an adoption needs it again
+                ws.visited[p] = false;
+                activeHead = (activeHead + 1) % n;
+                activeSize--;
+            }
+        }
+        if (a == SolverWorkspace::NONE) break;
+
+        // augment along src -> ... -> s -> t -> ... -> snk, in which the arc a joins s and t
+        bool fromSource = ws.tree[g.tail(a)] == SolverWorkspace::SOURCE_TREE;
+        unsigned s = fromSource ? g.tail(a) : g.head(a), t = fromSource ? g.head(a) : g.tail(a);
+        double cf = residualC(ws, a, !fromSource);
+        for (unsigned v = s; v != src; v = linkParent(g, ws.treeParent[v])) {
+            cf = std::min(cf, treeResidual(ws, SolverWorkspace::SOURCE_TREE, ws.treeParent[v]));
+        }
+        for (unsigned v = t; v != snk; v = linkParent(g, ws.treeParent[v])) {
+            cf = std::min(cf, treeResidual(ws, SolverWorkspace::SINK_TREE, ws.treeParent[v]));
         }
-        for(Edge* adj : v->getIncoming()){
-            testAndVisit(aux, adj, adj->getOrig(), residualC(adj, true));
+        ws.push(a, fromSource ? cf : -cf);
+        for (unsigned v = s; v != src; ) {
+            unsigned link = ws.treeParent[v], parent = linkParent(g, link);
+            ws.flow[link >> 1] += link & 1 ? -cf : cf;
+            if (treeResidual(ws, SolverWorkspace::SOURCE_TREE, link) <= 0) makeOrphan(v);
+            v = parent;
         }
+        for (unsigned v = t; v != snk; ) {
+            unsigned link = ws.treeParent[v], parent = linkParent(g, link);
+            ws.flow[link >> 1] += link & 1 ? cf : -cf;
+            if (treeResidual(ws, SolverWorkspace::SINK_TREE, link) <= 0) makeOrphan(v);
+            v = parent;
+        }
+        adoptOrphans();
     }
-    return target->isVisited();
+    ws.treesValid = true;
 }
-double reverseGetCf(Vertex* source, Vertex* target) {
-    double minC = INF;
-    Vertex *curr = target;
-    while (curr != source) {
-        bool outgoing = curr->getPath()->getDest() == curr;
-        minC = std::min(minC, residualC(curr->getPath(), !outgoing));
-        curr = outgoing ? curr->getPath()->getOrig() : curr->getPath()->getDest();
+
+/********************** Dinic  ****************************/
+
+bool buildLevelGraph(SolverWorkspace& ws, unsigned src, unsigned target) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned* queue = ws.frontier.data();
+    unsigned head = 0, tail = 0;
+    ws.newSearch();
+    queue[tail++] = src;
+    ws.label(src);
+    ws.level[src] = 0;
+    while(head < tail){
+        unsigned v = queue[head++];
+        if (ws.isLabeled(target) && ws.level[v] >= ws.level[target]) break; // deeper vertices cannot reach the sink
+        for(unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++){
+            unsigned w = g.head(a);
+            if (!ws.isLabeled(w) && ws.residual(a) > 0 && ws.isUsable(a)) {
+                ws.label(w);
+                ws.level[w] = ws.level[v] + 1;
+                queue[tail++] = w;
+            }
+        }
     }
-    return minC;
+    return ws.isLabeled(target);
+}
+
+bool isLevelArc(const SolverWorkspace& ws, unsigned v, unsigned a) {
+    unsigned w = ws.getGraph().head(a);
+    return ws.isLabeled(w) && ws.level[w] == ws.level[v] + 1 && ws.residual(a) > 0 && ws.isUsable(a);
 }
 
-void MaxFlow::reverseMaxFlow(const string& source, const string& sink, Graph* network) {
-    Vertex* src = network->findVertex(source);
-    Vertex* snk = network->findVertex(sink);
-    while(reverseFindAugPath(network, src, snk)){
-        double cf = reverseGetCf(src, snk);
-        augmentPath(src, snk, -cf);
+void blockingFlow(SolverWorkspace& ws, unsigned src, unsigned target) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned* stack = ws.frontier.data();   // arcs of the current path, the BFS is over
+    unsigned depth = 0;
+    for (unsigned v = 0; v < g.getNumVertex(); v++) ws.currentArc[v] = g.arcBegin(v);
+    unsigned v = src;
+    while (true) {
+        if (v == target) {
+            double cf = INF;
+            unsigned bottleneck = 0;
+            for (unsigned i = 0; i < depth; i++) {
+                if (ws.residual(stack[i]) < cf) {
+                    cf = ws.residual(stack[i]);
+                    bottleneck = i;
+                }
+            }
+            for (unsigned i = 0; i < depth; i++) ws.push(stack[i], cf);
+            // resume from the tail of the first saturated arc, which is no longer part of the level graph
+            depth = bottleneck;
+            v = g.tail(stack[depth]);
+            ws.currentArc[v]++;
+            continue;
+        }
+        unsigned& a = ws.currentArc[v];
+        while (a < g.arcEnd(v) && !isLevelArc(ws, v, a)) a++;
+        if (a < g.arcEnd(v)) {
+            stack[depth++] = a;
+            v = g.head(a);
+        } else {
+            ws.level[v] = SolverWorkspace::NONE;  // dead end, no path to the sink through v in this phase
+            if (depth == 0) return;
+            v = g.tail(stack[--depth]);
+            ws.currentArc[v]++;
+        }
     }
 }
 
+void MaxFlow::dinic(unsigned src, unsigned snk, SolverWorkspace& ws) {
+    while (buildLevelGraph(ws, src, snk)) {
+        blockingFlow(ws, src, snk);
+    }
+}
 
+/********************** Push-relabel  ****************************/
 
-/********************** Delete with paths  ****************************/
+/*
+ * The heights are kept in ws.level. Vertices that can reach the sink have the height of their residual distance to
+ * it; the others have V plus their residual distance to the source.
+ */
 
-void MaxFlow::augmentPathList(Vertex* source, Vertex* target, double cf) {
-    Vertex* curr = target;
-    vector<pair<bool, Edge*>> path;
-    while (curr != source){
-        bool outgoing = curr->getPath()->getDest() == curr;
-        path.emplace_back(outgoing, curr->getPath());
-        curr->getPath()->setFlow(outgoing ? curr->getPath()->getFlow() + cf : curr->getPath()->getFlow() - cf);
-        curr = outgoing ? curr->getPath()->getOrig() : curr->getPath()->getDest();
+void setHeight(SolverWorkspace& ws, unsigned v, unsigned h) {
+    ws.labelCount[ws.level[v]]--;
+    ws.level[v] = h;
+    ws.labelCount[h]++;
+}
+
+void reverseBfs(SolverWorkspace& ws, unsigned from, unsigned base, unsigned skip) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned* queue = ws.frontier.data();
+    unsigned head = 0, tail = 0;
+    queue[tail++] = from;
+    while (head < tail) {
+        unsigned w = queue[head++];
+        for (unsigned a = g.arcBegin(w); a < g.arcEnd(w); a++) {
+            unsigned u = g.head(a);
+            // the arc u -> w over the same edge has the residual capacity of a taken backwards
+            if (u == skip || ws.isLabeled(u) || !ws.vertexActive[u] || !ws.edgeActive[g.edgeOf(a)]) continue;
+            if (residualC(ws, a, true) <= 0) continue;
+            ws.label(u);
+            setHeight(ws, u, ws.level[w] + 1 < base ? base : ws.level[w] + 1);
+            queue[tail++] = u;
+        }
     }
-    path.erase(path.end()-1);
-    for (auto e: path) {
-        e.second->addPath(free.empty() ? paths.size() : free.at(0));
-        e.second->getDest()->addPath(free.empty() ? paths.size() : free.at(0));
-        e.second->getOrig()->addPath(free.empty() ? paths.size() : free.at(0));
+}
+
+void globalRelabel(SolverWorkspace& ws, unsigned src, unsigned target) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned n = g.getNumVertex();
+    ws.newSearch();
+    ws.label(target);
+    ws.label(src);
+    reverseBfs(ws, target, 0, src);
+    reverseBfs(ws, src, n + 1, target);
+    for (unsigned v = 0; v < n; v++) {
+        if (!ws.isLabeled(v)) setHeight(ws, v, 2 * n);  // cannot move flow anywhere
+        ws.currentArc[v] = g.arcBegin(v);
     }
-    paths.emplace(free.empty()? paths.size(): free.at(0), pair<double, vector<pair<bool, Edge*>>>{make_pair(cf, path)});
-    if (!free.empty()) free.erase(free.begin());
 }
 
-void MaxFlow::maxFlowWithList(Graph* network) {
-    Vertex* src = network->findVertex("src");
-    Vertex* snk = network->findVertex("sink");
-    while(findAugPath(network, src, snk)){
-        double cf = getCf(src, snk);
-        augmentPathList(src, snk, cf);
+void MaxFlow::pushRelabel(unsigned src, unsigned snk, SolverWorkspace& ws) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned n = g.getNumVertex();
+    std::fill(ws.excess.begin(), ws.excess.end(), 0);
+    std::fill(ws.labelCount.begin(), ws.labelCount.end(), 0);
+    for (unsigned e = 0; e < g.getNumEdge(); e++) {
+        ws.excess[g.getOrig(e)] -= ws.flow[e];
+        ws.excess[g.getDest(e)] += ws.flow[e];
+    }
+    for (unsigned v = 0; v < n; v++) ws.level[v] = 0;
+    ws.labelCount[0] = n;
+    setHeight(ws, src, n);
+    for (unsigned a = g.arcBegin(src); a < g.arcEnd(src); a++) {
+        double r = ws.residual(a);
+        if (r <= 0 || !ws.isUsable(a)) continue;
+        ws.push(a, r);
+        ws.excess[src] -= r;
+        ws.excess[g.head(a)] += r;
     }
+    globalRelabel(ws, src, snk);
+
+    // FIFO of active vertices, each vertex is at most once in the queue
+    unsigned* queue = ws.active.data();
+    unsigned head = 0, size = 0;
+    std::fill(ws.visited.begin(), ws.visited.end(), false);
+    auto enqueue = [&](unsigned v, bool secondPhase) {
+        if (ws.visited[v] || v == src || v == snk || ws.excess[v] <= 0 || !ws.vertexActive[v]) return;
+        if (!secondPhase && ws.level[v] >= n) return;  // cannot reach the sink, left for the second phase
+        ws.visited[v] = true;
+        queue[(head + size++) % n] = v;
+    };
+
+    for (int phase = 0; phase < 2; phase++) {
+        bool secondPhase = phase == 1;
+        for (unsigned v = 0; v < n; v++) enqueue(v, secondPhase);
+        unsigned relabels = 0;
+        while (size > 0) {
+            unsigned v = queue[head];
+            head = (head + 1) % n;
+            size--;
+            ws.visited[v] = false;
+            if (!secondPhase && ws.level[v] >= n) continue;
+            while (ws.excess[v] > 0) {
+                if (ws.currentArc[v] == g.arcEnd(v)) {
+                    // relabel to one more than the lowest neighbour reachable through a residual arc
+                    unsigned oldHeight = ws.level[v], newHeight = 2 * n;
+                    for (unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++) {
+                        if (ws.residual(a) > 0 && ws.isUsable(a)) newHeight = std::min(newHeight, ws.level[g.head(a)] + 1);
+                    }
+                    setHeight(ws, v, newHeight);
+                    ws.currentArc[v] = g.arcBegin(v);
+                    if (oldHeight < n && ws.labelCount[oldHeight] == 0) {
+                        // gap: nothing above the empty height can reach the sink anymore
+                        for (unsigned u = 0; u < n; u++) {
+                            if (u != src && ws.level[u] > oldHeight && ws.level[u] < n) setHeight(ws, u, n + 1);
+                        }
+                    }
+                    if (++relabels >= n) {
+                        globalRelabel(ws, src, snk);
+                        relabels = 0;
+                    }
+                    if (!secondPhase && ws.level[v] >= n) break;
+                    continue;
+                }
+                unsigned a = ws.currentArc[v];
+                unsigned w = g.head(a);
+                double r = ws.residual(a);
+                if (r > 0 && ws.isUsable(a) && ws.level[v] == ws.level[w] + 1) {
+                    double delta = std::min(ws.excess[v], r);
+                    ws.push(a, delta);
+                    ws.excess[v] -= delta;
+                    ws.excess[w] += delta;
+                    enqueue(w, secondPhase);
+                }
+                else ws.currentArc[v]++;
+            }
+        }
+    }
+}
+
+/********************** Parallel push-relabel  ****************************/
+
+/*
+ * Lock-free push-relabel in the style of Hong: every vertex is owned by one thread, and only that thread pushes out
+ * of it or relabels it, so the only contention is on the flow of an edge and the excess of the vertex receiving a
+ * push, which are updated with atomic additions. Other threads only ever increase the residual capacities and
+ * excesses the owner reads, so the amount it decides to push is always still available when the push happens.
+ * Threads synchronise at a barrier after every sweep over their vertices; the global relabel runs there, while no
+ * thread is pushing.
+ */
+
+void atomicAdd(atomic<double>& target, double delta) {
+    double current = target.load(memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + delta, memory_order_relaxed)) {}
 }
 
+void MaxFlow::parallelPushRelabel(unsigned src, unsigned snk, SolverWorkspace& ws) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned n = g.getNumVertex(), m = g.getNumEdge();
+    unsigned numThreads = ws.threads != 0 ? ws.threads : std::thread::hardware_concurrency();
+    numThreads = std::max(1u, std::min(numThreads, n));
+
+    // saturate the source and compute exact heights, exactly as the sequential engine does
+    std::fill(ws.excess.begin(), ws.excess.end(), 0);
+    std::fill(ws.labelCount.begin(), ws.labelCount.end(), 0);
+    for (unsigned e = 0; e < m; e++) {
+        ws.excess[g.getOrig(e)] -= ws.flow[e];
+        ws.excess[g.getDest(e)] += ws.flow[e];
+    }
+    for (unsigned v = 0; v < n; v++) ws.level[v] = 0;
+    ws.labelCount[0] = n;
+    setHeight(ws, src, n);
+    for (unsigned a = g.arcBegin(src); a < g.arcEnd(src); a++) {
+        double r = ws.residual(a);
+        if (r <= 0 || !ws.isUsable(a)) continue;
+        ws.push(a, r);
+        ws.excess[src] -= r;
+        ws.excess[g.head(a)] += r;
+    }
+    globalRelabel(ws, src, snk);
+
+    vector<atomic<double>> flow(m), excess(n);
+    vector<atomic<unsigned>> height(n);
+    for (unsigned e = 0; e < m; e++) flow[e].store(ws.flow[e], memory_order_relaxed);
+    for (unsigned v = 0; v < n; v++) {
+        excess[v].store(ws.excess[v], memory_order_relaxed);
+        height[v].store(ws.level[v], memory_order_relaxed);
+    }
+    auto residual = [&](unsigned a) {
+        unsigned e = g.edgeOf(a);
+        double f = flow[e].load(memory_order_relaxed);
+        return g.isForward(a) ? ws.capacity[e] - f : f;
+    };
+    auto isActive = [&](unsigned v) {
+        return v != src && v != snk && ws.vertexActive[v] && excess[v].load(memory_order_relaxed) > 0
+               && height[v].load(memory_order_relaxed) < 2 * n;
+    };
+
+    ws.threadWork.assign(numThreads, SolverWorkspace::ThreadWork());
+    Barrier barrier(numThreads + 1);
+    atomic<unsigned long> relabels(0);
+    bool done = false;  // only written between two barriers
 
-void MaxFlow::resetPaths(const std::unordered_set<int>& pathSet) {
-    for (auto k: pathSet) {
-        if (paths.count(k)) {
-            for (auto e: paths.at(k).second) {
-                if (e.second->hasPath(k)) {
-                    e.second->setFlow(e.second->getFlow() - (e.first ? paths.at(k).first: -paths.at(k).first));
-                    e.second->removePath(k);
-                    e.second->getDest()->removePath(k);
-                    e.second->getOrig()->removePath(k);
-                    if (e.second->getFlow() < 0) resetPaths(e.second->getPaths());
+    auto worker = [&](unsigned t) {
+        SolverWorkspace::ThreadWork& work = ws.threadWork[t];
+        unsigned first = (unsigned long) n * t / numThreads, last = (unsigned long) n * (t + 1) / numThreads;
+        while (true) {
+            barrier.wait();
+            if (done) break;
+            auto start = chrono::steady_clock::now();
+            unsigned long roundRelabels = 0;
+            for (unsigned v = first; v < last; v++) {
+                if (!isActive(v)) continue;
+                // bounded discharge, so that one vertex cannot hold back the barrier for long
+                for (unsigned ops = g.arcEnd(v) - g.arcBegin(v) + 1; ops > 0 && isActive(v); ops--) {
+                    unsigned lowest = 2 * n, lowestArc = 0;
+                    for (unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++) {
+                        if (residual(a) <= 0 || !ws.isUsable(a)) continue;
+                        unsigned h = height[g.head(a)].load(memory_order_relaxed);
+                        if (h < lowest) {
+                            lowest = h;
+                            lowestArc = a;
+                        }
+                    }
+                    unsigned h = height[v].load(memory_order_relaxed);
+                    if (lowest < h) {
+                        double delta = std::min(excess[v].load(memory_order_relaxed), residual(lowestArc));
+                        atomicAdd(flow[g.edgeOf(lowestArc)], g.isForward(lowestArc) ? delta : -delta);
+                        atomicAdd(excess[v], -delta);
+                        atomicAdd(excess[g.head(lowestArc)], delta);
+                        work.pushes++;
+                    }
+                    else {
+                        height[v].store(lowest == 2 * n ? 2 * n : lowest + 1, memory_order_relaxed);
+                        roundRelabels++;
+                    }
                 }
             }
-            paths.erase(k);
-            free.push_back(k);
+            work.relabels += roundRelabels;
+            relabels += roundRelabels;
+            work.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            barrier.wait();
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned t = 0; t < numThreads; t++) threads.emplace_back(worker, t);
+    while (true) {
+        done = true;
+        for (unsigned v = 0; v < n && done; v++) done = !isActive(v);
+        barrier.wait();
+        if (done) break;
+        barrier.wait();
+        if (relabels >= n) {
+            // the threads are all waiting at the barrier, so the sequential global relabel can run on a snapshot
+            std::fill(ws.labelCount.begin(), ws.labelCount.end(), 0);
+            for (unsigned e = 0; e < m; e++) ws.flow[e] = flow[e].load(memory_order_relaxed);
+            for (unsigned v = 0; v < n; v++) {
+                ws.level[v] = height[v].load(memory_order_relaxed);
+                ws.labelCount[ws.level[v]]++;
+            }
+            globalRelabel(ws, src, snk);
+            for (unsigned v = 0; v < n; v++) height[v].store(ws.level[v], memory_order_relaxed);
+            relabels = 0;
         }
     }
+    for (thread& t: threads) t.join();
+
+    for (unsigned e = 0; e < m; e++) ws.flow[e] = flow[e].load(memory_order_relaxed);
+    for (unsigned v = 0; v < n; v++) {
+        ws.excess[v] = excess[v].load(memory_order_relaxed);
+        ws.level[v] = height[v].load(memory_order_relaxed);
+    }
+}
+
+/********************** MaxFlow Reverse  ****************************/
+
+void MaxFlow::reverseMaxFlow(const string& source, const string& sink, Graph* network, SolverWorkspace& ws) {
+    reverseMaxFlow(network->findVertexId(source), network->findVertexId(sink), network, ws);
+}
+
+void MaxFlow::reverseMaxFlow(unsigned src, unsigned snk, Graph* network, SolverWorkspace& ws) {
+    ws.attach(*network->getFlowGraph());
+    ws.load();
+    while(findAugPath(ws, src, snk, true)){
+        double cf = getCf(ws, src, snk, true);
+        augmentPath(ws, src, snk, -cf);
+    }
+    ws.store();
+}
+
+
+
+/********************** Decremental deletion  ****************************/
+
+/*
+ * Deleting a component zeroes the flow of its edges, which leaves a surplus at the tail and a deficit at the head of
+ * each of them. The surplus is cancelled by following the flow backwards until the source, or a vertex with a
+ * deficit, and the deficit by following it forwards until the sink; only the flow that crossed the component changes.
+ */
+
+unsigned findFlowPath(SolverWorkspace& ws, unsigned from, bool forward, unsigned terminal) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned* queue = ws.frontier.data();
+    unsigned head = 0, tail = 0;
+    ws.newSearch();
+    queue[tail++] = from;
+    ws.label(from);
+    while (head < tail) {
+        unsigned v = queue[head++];
+        for (unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++) {
+            unsigned w = g.head(a);
+            if (g.isForward(a) != forward || ws.isLabeled(w) || ws.flow[g.edgeOf(a)] <= 0) continue;
+            ws.label(w);
+            ws.path[w] = a;
+            if (w == terminal || (forward ? ws.excess[w] > 0 : ws.excess[w] < 0)) return w;
+            queue[tail++] = w;
+        }
+    }
+    return SolverWorkspace::NONE;
+}
+
+bool cancelImbalance(SolverWorkspace& ws, unsigned src, unsigned snk, const vector<unsigned>& touched) {
+    for (unsigned v: touched) {
+        while (v != src && v != snk && ws.excess[v] > 0) {
+            unsigned t = findFlowPath(ws, v, false, src);
+            if (t == SolverWorkspace::NONE) return false;
+            double cf = std::min(ws.excess[v], getCf(ws, v, t));
+            if (t != src) cf = std::min(cf, -ws.excess[t]);
+            augmentPath(ws, v, t, cf);
+            ws.excess[v] -= cf;
+            ws.excess[t] += cf;
+        }
+    }
+    for (unsigned v: touched) {
+        while (v != src && v != snk && ws.excess[v] < 0) {
+            unsigned t = findFlowPath(ws, v, true, snk);
+            if (t == SolverWorkspace::NONE) return false;
+            double cf = std::min(-ws.excess[v], getCf(ws, v, t, true));
+            if (t != snk) cf = std::min(cf, ws.excess[t]);
+            augmentPath(ws, v, t, -cf);
+            ws.excess[v] += cf;
+            ws.excess[t] -= cf;
+        }
+    }
+    return true;
+}
+
+vector<unsigned> zeroCut(SolverWorkspace& ws, const vector<unsigned>& cut) {
+    // returns the endpoints of the cut edges that carried flow, now unbalanced by it
+    const FlowGraph& g = ws.getGraph();
+    std::fill(ws.excess.begin(), ws.excess.end(), 0);
+    vector<unsigned> touched;
+    for (unsigned e: cut) {
+        if (ws.flow[e] == 0) continue;
+        ws.excess[g.getOrig(e)] += ws.flow[e];
+        ws.excess[g.getDest(e)] -= ws.flow[e];
+        ws.flow[e] = 0;
+        touched.push_back(g.getOrig(e));
+        touched.push_back(g.getDest(e));
+    }
+    return touched;
+}
+
+void MaxFlow::removeCut(unsigned src, unsigned snk, SolverWorkspace& ws, const vector<unsigned>& cut,
+                        MaxFlowEngine engine) {
+    if (!cancelImbalance(ws, src, snk, zeroCut(ws, cut))) {
+        std::fill(ws.flow.begin(), ws.flow.end(), 0);  // the workspace did not hold a flow, solve from scratch
+    }
+    run(src, snk, ws, engine);
+}
+
+void removeFlow(Graph* network, SolverWorkspace& ws, const vector<Edge*>& cut, MaxFlowEngine engine) {
+    ws.attach(*network->getFlowGraph());
+    ws.load();
+    vector<unsigned> ids;
+    for (Edge* edge: cut) ids.push_back(edge->getId());
+    MaxFlow::removeCut(network->findVertexId("src"), network->findVertexId("sink"), ws, ids, engine);
+    ws.store();
 }
 
-void MaxFlow::deleteReservoir(const std::string& reservoir, Graph* network) {
+void MaxFlow::deleteReservoir(const std::string& reservoir, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
+    deleteReservoir(network->findVertexId(reservoir), network, ws, engine);
+}
+
+void MaxFlow::deleteReservoir(unsigned reservoir, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
     Vertex* v = network->findVertex(reservoir);
-    resetPaths(v->getPaths());
     v->desactivate();
-    maxFlowWithList(network);
+    vector<Edge*> cut(v->getAdj());
+    cut.insert(cut.end(), v->getIncoming().begin(), v->getIncoming().end());
+    removeFlow(network, ws, cut, engine);
 }
 
-void MaxFlow::deleteStation(const std::string& station, Graph* network) {
+void MaxFlow::deleteStation(const std::string& station, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
+    deleteStation(network->findVertexId(station), network, ws, engine);
+}
+
+void MaxFlow::deleteStation(unsigned station, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
     Vertex* v = network->findVertex(station);
-    resetPaths(v->getPaths());
     v->desactivate();
-    maxFlowWithList(network);
+    vector<Edge*> cut(v->getAdj());
+    cut.insert(cut.end(), v->getIncoming().begin(), v->getIncoming().end());
+    removeFlow(network, ws, cut, engine);
+}
+
+void MaxFlow::deletePipe(const std::string& source, const std::string& dest, Graph* network, SolverWorkspace& ws,
+                         MaxFlowEngine engine) {
+    deletePipe(network->findVertexId(source), network->findVertexId(dest), network, ws, engine);
 }
 
-void MaxFlow::deletePipe(const std::string& source, const std::string& dest, Graph* network) {
+void MaxFlow::deletePipe(unsigned source, unsigned dest, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
     auto edge = network->findEdge(source, dest);
-    resetPaths(edge->getPaths());
-    if (edge->getReverse() != nullptr) resetPaths(edge->getReverse()->getPaths());
+    vector<Edge*> cut{edge};
     edge->desactivate();
-    if (edge->getReverse() != nullptr) edge->getReverse()->desactivate();
-    maxFlowWithList(network);
+    if (edge->getReverse() != nullptr) {
+        edge->getReverse()->desactivate();
+        cut.push_back(edge->getReverse());
+    }
+    removeFlow(network, ws, cut, engine);
 }
 
-void MaxFlow::reliabilityPrep(Graph* network) {
-    paths.clear();
-    free.clear();
-    for (auto v: network->getVertexSet()) {
-        v.second->resetPath();
-        for (auto e: v.second->getAdj()) {
-            e->resetPath();
-            e->setFlow(0);
+void MaxFlow::reliabilityPrep(Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
+    network->resetFlow();
+    maxFlow(network->findVertexId("src"), network->findVertexId("sink"), network, ws, engine);
+}
+
+/********************** Removal pruning  ****************************/
+
+bool rerouteAroundCut(SolverWorkspace& ws, unsigned src, const vector<unsigned>& touched) {
+    for (unsigned u: touched) {
+        while (u != src && ws.excess[u] > 0) {
+            if (!findAugPath(ws, u, src)) return false;
+            double cf = std::min(ws.excess[u], getCf(ws, u, src));
+            augmentPath(ws, u, src, cf);
+            ws.excess[u] -= cf;
+        }
+    }
+    for (unsigned d: touched) {
+        while (d != src && ws.excess[d] < 0) {
+            if (!findAugPath(ws, src, d)) return false;
+            double cf = std::min(-ws.excess[d], getCf(ws, src, d));
+            augmentPath(ws, src, d, cf);
+            ws.excess[d] += cf;
         }
     }
-    maxFlowWithList(network);
+    return true;
 }
 
-bool findMinAugmentingPath(Graph* network, const string& source, const string& target, double(*cost)(Edge*)){
-    MutablePriorityQueue q;
-    for(auto v : network->getVertexSet()){
-        v.second->setDist(INF);
-        v.second->setPath(nullptr);
-        v.second->setVisited(false);
+bool MaxFlow::isCutNeutral(unsigned src, unsigned snk, SolverWorkspace& ws, const vector<unsigned>& cut) {
+    vector<unsigned> touched = zeroCut(ws, cut);
+    if (touched.empty()) return true;  // no flow crossed the component
+    if (ws.excess[snk] != 0) return false;
+    // with the sink disabled no path can move supply from one City to another: the surplus goes back to the source
+    // and the deficits are fed from it, so the Cities keep their flow if both succeed
+    char sinkActive = ws.vertexActive[snk];
+    ws.vertexActive[snk] = false;
+    bool neutral = rerouteAroundCut(ws, src, touched);
+    ws.vertexActive[snk] = sinkActive;
+    return neutral;
+}
+
+bool checkRemoval(Graph* network, SolverWorkspace& ws, const vector<double>& baseline, const vector<Edge*>& cut,
+                  Vertex* removed) {
+    ws.attach(*network->getFlowGraph());
+    ws.load();
+    ws.flow = baseline;
+    vector<unsigned> ids;
+    for (Edge* edge: cut) {
+        ids.push_back(edge->getId());
+        ws.edgeActive[edge->getId()] = false;
     }
-    auto *start = network->findVertex(source);
-    start->setDist(0);
-    q.insert(start);
+    if (removed != nullptr) ws.vertexActive[removed->getId()] = false;
+    return MaxFlow::isCutNeutral(network->findVertexId("src"), network->findVertexId("sink"), ws, ids);
+}
+
+bool MaxFlow::isRemovalNeutral(Graph* network, SolverWorkspace& ws, const vector<double>& baseline, Vertex* removed) {
+    vector<Edge*> cut(removed->getAdj());
+    cut.insert(cut.end(), removed->getIncoming().begin(), removed->getIncoming().end());
+    return checkRemoval(network, ws, baseline, cut, removed);
+}
+
+bool MaxFlow::isRemovalNeutral(Graph* network, SolverWorkspace& ws, const vector<double>& baseline, Edge* pipe) {
+    vector<Edge*> cut{pipe};
+    if (pipe->getReverse() != nullptr) cut.push_back(pipe->getReverse());
+    return checkRemoval(network, ws, baseline, cut, nullptr);
+}
+
+double emptiestCost(const SolverWorkspace& ws, unsigned e) {
+    return 1 / (ws.capacity[e] - ws.flow[e]);
+}
+
+void costsToTarget(SolverWorkspace& ws, unsigned target, vector<double>& toTarget) {
+    // backward Dijkstra through the incoming usable edges, INF for the vertices that cannot reach the target
+    const FlowGraph& g = ws.getGraph();
+    IndexedHeap<double> q(ws.queueIndex);
+    std::fill(toTarget.begin(), toTarget.end(), INF);
+    std::fill(ws.visited.begin(), ws.visited.end(), false);
+    toTarget[target] = 0;
+    q.insert(target, 0);
     while(!q.empty()){
-        Vertex* v = q.extractMin();
-        v->setVisited(true);
-        if(!v->checkActive()) continue;
-        for(auto* e : v->getAdj()){
-            if(!e->checkActive() || e->getFlow() == e->getWeight()) continue;
-            Vertex* w = e->getDest();
-            if(!w->checkActive() || w->isVisited()) continue;
-            double currentCost = w->getDist(), nextCost = v->getDist() + cost(e);
-            if(currentCost > nextCost){
-                w->setPath(e);
-                w->setDist(nextCost);
-                if(currentCost == INF)
-                    q.insert(w);
+        unsigned v = q.extractMin();
+        ws.visited[v] = true;
+        for(unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++){
+            unsigned e = g.edgeOf(a), u = g.head(a);
+            if(g.isForward(a) || ws.visited[u] || !ws.edgeActive[e] || !ws.vertexActive[u] || ws.capacity[e] - ws.flow[e] <= 0) continue;
+            double d = toTarget[v] + emptiestCost(ws, e);
+            if(d < toTarget[u]){
+                if(toTarget[u] == INF)
+                    q.insert(u, d);
                 else
-                    q.decreaseKey(w);
+                    q.decreaseKey(u, d);
+                toTarget[u] = d;
             }
         }
     }
-    return network->findVertex(target)->isVisited();
 }
 
-void MaxFlow::balancedMaxFlow(Graph* network, const string& source, const string& sink){
-    Vertex* src = network->findVertex(source);
-    Vertex* snk = network->findVertex(sink);
-    network->resetFlow();
-    while(findMinAugmentingPath(network, source, sink,
-            [](Edge* edge) -> double { return 1/(edge->getWeight() - edge->getFlow());})){
-        double cf = getCf(src, snk);
-        augmentPath(src, snk, cf);
+bool findMinAugmentingPath(SolverWorkspace& ws, unsigned source, unsigned target, vector<double>& toTarget){
+    // A* ordered by dist + toTarget, which never overestimates since augmenting only raises costs and removes edges.
+    // Labeled vertices are in the queue or settled, the settled ones are listed in the frontier buffer
+    const FlowGraph& g = ws.getGraph();
+    IndexedHeap<double> q(ws.queueIndex);
+    unsigned settled = 0;
+    ws.newSearch();
+    ws.label(source);
+    ws.visited[source] = false;
+    ws.dist[source] = 0;
+    q.insert(source, toTarget[source]);
+    while(!q.empty()){
+        unsigned v = q.extractMin();
+        ws.visited[v] = true;
+        ws.frontier[settled++] = v;
+        if(v == target) break;
+        if(!ws.vertexActive[v]) continue;
+        for(unsigned a = g.arcBegin(v); a < g.arcEnd(v); a++){
+            if(!g.isForward(a) || !ws.isUsable(a) || ws.residual(a) == 0) continue;
+            unsigned w = g.head(a);
+            if(toTarget[w] == INF || (ws.isLabeled(w) && ws.visited[w])) continue;
+            double nextCost = ws.dist[v] + emptiestCost(ws, g.edgeOf(a));
+            if(!ws.isLabeled(w)){
+                ws.label(w);
+                ws.visited[w] = false;
+                ws.dist[w] = nextCost;
+                ws.path[w] = a;
+                q.insert(w, nextCost + toTarget[w]);
+            }
+            else if(nextCost < ws.dist[w]){
+                ws.dist[w] = nextCost;
+                ws.path[w] = a;
+                q.decreaseKey(w, nextCost + toTarget[w]);
+            }
+        }
+    }
+    if(!ws.isLabeled(target) || !ws.visited[target]) return false;
+    // a vertex settled at dist d is at least dist(target) - d away from the target, which tightens the estimate
+    // around the path for the next search
+    for(unsigned i = 0; i < settled; i++){
+        unsigned v = ws.frontier[i];
+        toTarget[v] = std::max(toTarget[v], ws.dist[target] - ws.dist[v]);
     }
+    return true;
 }
 
-std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge *>>>> MaxFlow::getPaths() {
-    return paths;
+void MaxFlow::balancedMaxFlow(Graph* network, const string& source, const string& sink, SolverWorkspace& ws){
+    balancedMaxFlow(network, network->findVertexId(source), network->findVertexId(sink), ws);
 }
 
-void
-MaxFlow::setPaths(std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge *>>>> paths, Graph* network) {
-    this->paths = paths;
-    free.clear();
-    for (auto v: network->getVertexSet()) {
-        v.second->resetPath();
-        for (auto e: v.second->getAdj()) {
-            e->resetPath();
-        }
-    }
-    for (auto e: paths) {
-        for (auto v: e.second.second) {
-            v.second->getDest()->addPath(e.first);
-            v.second->getOrig()->addPath(e.first);
-            v.second->addPath(e.first);
-        }
+void MaxFlow::balancedMaxFlow(Graph* network, unsigned src, unsigned snk, SolverWorkspace& ws){
+    network->resetFlow();
+    ws.attach(*network->getFlowGraph());
+    ws.load();
+    vector<double> toTarget(ws.getGraph().getNumVertex());
+    costsToTarget(ws, snk, toTarget);
+    while(findMinAugmentingPath(ws, src, snk, toTarget)){
+        double cf = getCf(ws, src, snk);
+        augmentPath(ws, src, snk, cf);
     }
+    ws.store();
+}
+
+void MaxFlow::deleteReservoirScratch(const std::string& reservoir, Graph* network, SolverWorkspace& ws) {
+    deleteReservoirScratch(network->findVertexId(reservoir), network, ws);
 }
 
-void MaxFlow::deleteReservoirScratch(const std::string& reservoir, Graph* network) {
+void MaxFlow::deleteReservoirScratch(unsigned reservoir, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
     Vertex* v = network->findVertex(reservoir);
     v->desactivate();
     network->resetFlow();
-    maxFlow("src", "sink", network);
+    maxFlow(network->findVertexId("src"), network->findVertexId("sink"), network, ws, engine);
+}
+
+void MaxFlow::deleteStationScratch(const std::string& station, Graph* network, SolverWorkspace& ws) {
+    deleteStationScratch(network->findVertexId(station), network, ws);
 }
 
-void MaxFlow::deleteStationScratch(const std::string& station, Graph* network) {
+void MaxFlow::deleteStationScratch(unsigned station, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
     Vertex* v = network->findVertex(station);
     v->desactivate();
     network->resetFlow();
-    maxFlow("src", "sink", network);
+    maxFlow(network->findVertexId("src"), network->findVertexId("sink"), network, ws, engine);
+}
+
+void MaxFlow::deletePipeScratch(const std::string& source, const std::string& dest, Graph* network, SolverWorkspace& ws) {
+    deletePipeScratch(network->findVertexId(source), network->findVertexId(dest), network, ws);
 }
 
-void MaxFlow::deletePipeScratch(const std::string& source, const std::string& dest, Graph* network) {
+void MaxFlow::deletePipeScratch(unsigned source, unsigned dest, Graph* network, SolverWorkspace& ws, MaxFlowEngine engine) {
     auto edge = network->findEdge(source, dest);
     edge->desactivate();
     if (edge->getReverse() != nullptr) edge->getReverse()->desactivate();
     network->resetFlow();
-    maxFlow("src", "sink", network);
+    maxFlow(network->findVertexId("src"), network->findVertexId("sink"), network, ws, engine);
 }
\ No newline at end of file
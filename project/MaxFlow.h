@@ -1,18 +1,36 @@
 #ifndef WATERSUPPLYMANAGER_MAXFLOW_H
 #define WATERSUPPLYMANAGER_MAXFLOW_H
 
-#include <unordered_map>
 #include <vector>
 #include "datastructures/Graph.h"
+#include "datastructures/FlowGraph.h"
+#include "datastructures/SolverWorkspace.h"
+
+/**
+ * \brief The algorithms that can compute a maximum flow.
+ */
+enum class MaxFlowEngine {
+    EDMONDS_KARP,  // one BFS per augmenting path
+    DINIC,         // one BFS per phase, then a blocking flow over the level graph
+    PUSH_RELABEL,  // FIFO push-relabel with the gap and global relabeling heuristics
+    PARALLEL_PUSH_RELABEL, // lock-free push-relabel spread over several threads
+    CAPACITY_SCALING,      // shortest augmenting paths through arcs with at least a halving residual threshold
+    BOYKOV_KOLMOGOROV      // two search trees that are kept between augmentations and between runs
+};
+
+/**
+ * \brief A change of the capacity of one Edge, applied by MaxFlow::reSolve().
+ */
+struct CapacityDelta {
+    Edge* edge;
+    double delta;  // added to the Edge weight, which is then kept within [0, INF]
+};
 
 /**
  * \class MaxFlow
  * \brief A custom class containing all maxFlow related algorithms.
  */
 class MaxFlow {
-private:
-    std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge*>>>> paths;
-    std::vector<unsigned int> free;
 public:
     /**
      * \brief Performs the maxFlow algorithm on the provided network Graph using the edmondsKarp algorithm.
@@ -20,144 +38,485 @@ public:
      * @param source The source vertex.
      * @param sink The sink vertex.
      * @param network The network Graph in which to perform the maxFlow.
+     * @param ws The workspace the algorithm runs in.
      *
      *\par Complexity
      * O(VE²) in which V is the number of vertex and E the number of edges of the Graph.
      */
-    static void maxFlow(const std::string& source, const std::string& sink, Graph* network);
+    static void maxFlow(const std::string& source, const std::string& sink, Graph* network, SolverWorkspace& ws);
+    /**
+     * \brief Performs the maxFlow algorithm on the provided network Graph using the given engine.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param network The network Graph in which to perform the maxFlow.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm to use, Edmonds-Karp by default.
+     *
+     *\par Complexity
+     * O(VE²) with Edmonds-Karp, O(E² log U) with capacity scaling, O(V²E) with Dinic and O(V³) with push-relabel, in
+     * which V is the number of vertex, E the number of edges and U the largest capacity of the Graph.
+     */
+    static void maxFlow(unsigned source, unsigned sink, Graph* network, SolverWorkspace& ws,
+                        MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
+    /**
+     * \brief Changes the capacity of some Edge and updates the max flow already in the network Graph instead of
+     * solving again from zero.
+     *
+     * The flow of an Edge above its new capacity is cut down to it; the surplus left at its origin is rerouted to its
+     * destination through other paths when possible, and otherwise given back to the source while the destination's
+     * deficit is taken from the sink. The selected engine then augments from the repaired flow.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param network The network Graph holding a flow from source to sink.
+     * @param ws The workspace the algorithm runs in.
+     * @param deltas The capacity changes, in the order they are applied.
+     * @param engine The algorithm to use, Edmonds-Karp by default.
+     *
+     *\par Complexity
+     * O(PE) for the repair, in which P is the number of paths that carry the flow removed by the capacity decreases
+     * and E the number of edges of the Graph, plus the cost of the engine for the flow still missing, which is small
+     * when only a few capacities change.
+     */
+    static void reSolve(unsigned source, unsigned sink, Graph* network, SolverWorkspace& ws,
+                        const std::vector<CapacityDelta>& deltas, MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
+    /**
+     * \brief Computes the lexicographic max flow of a list of targets in priority order on a workspace that is
+     * already attached and loaded: each target receives as much flow as possible without taking any from the targets
+     * before it, and the engine then fills every sink Edge with the remaining capacity.
+     *
+     * The targets are served in a single incremental pass over the same residual network. The set of vertices
+     * reachable from the source only shrinks as flow is augmented, so a target a search could not reach is skipped
+     * along with every later target out of reach, without searching again.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace holding a flow from source to sink.
+     * @param targets The IDs of the Edge from each target to the sink, highest priority first.
+     * @param engine The algorithm to use for the remaining capacity.
+     * @return The number of augmenting path searches the targets needed.
+     *
+     *\par Complexity
+     * O(PE + T V) in which P is the number of augmenting paths to the targets, T the number of targets, V the number
+     * of vertex and E the number of edges of the Graph, plus the cost of the engine for the remaining capacity.
+     */
+    static unsigned prioritizedMaxFlow(unsigned source, unsigned sink, SolverWorkspace& ws,
+                                       const std::vector<unsigned>& targets,
+                                       MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
+    /**
+     * \brief Computes the lexicographic max flow of a list of targets in priority order, starting from the flow of
+     * the network Graph.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param network The network Graph holding a flow from source to sink.
+     * @param ws The workspace the algorithm runs in.
+     * @param targets The Edge from each target to the sink, highest priority first.
+     * @param engine The algorithm to use for the remaining capacity, Edmonds-Karp by default.
+     *
+     *\par Complexity
+     * O(V + E) to load and store the network plus the cost of prioritizedMaxFlow() on the workspace.
+     */
+    static void prioritizedMaxFlow(unsigned source, unsigned sink, Graph* network, SolverWorkspace& ws,
+                                   const std::vector<Edge*>& targets,
+                                   MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
+    /**
+     * \brief Runs the given engine on a workspace that is already attached and loaded, starting from its flow.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm to use.
+     *
+     *\par Complexity
+     * The complexity of the engine.
+     */
+    static void run(unsigned source, unsigned sink, SolverWorkspace& ws, MaxFlowEngine engine);
+    /**
+     * \brief Performs the maxFlow algorithm on the workspace's network with Dinic's algorithm, starting from the flow
+     * already in the workspace.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace the algorithm runs in, already attached and loaded.
+     *
+     *\par Complexity
+     * O(V²E) in which V is the number of vertex and E the number of edges of the Graph.
+     */
+    static void dinic(unsigned source, unsigned sink, SolverWorkspace& ws);
+    /**
+     * \brief Performs the maxFlow algorithm on the workspace's network with capacity scaling, starting from the flow
+     * already in the workspace.
+     *
+     * Augmenting paths are searched only through arcs with a residual capacity of at least Δ, starting with the
+     * largest power of two not above the largest finite capacity and halving Δ whenever no such path is left.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace the algorithm runs in, already attached and loaded.
+     *
+     *\par Complexity
+     * O(E² log U) in which E is the number of edges of the Graph and U its largest finite capacity.
+     */
+    static void capacityScaling(unsigned source, unsigned sink, SolverWorkspace& ws);
+    /**
+     * \brief Performs the maxFlow algorithm on the workspace's network with the Boykov-Kolmogorov algorithm, starting
+     * from the flow already in the workspace.
+     *
+     * A source tree and a sink tree grow until they touch; after each augmentation only the vertices cut off from
+     * their root are reattached, instead of searching again from the source. The trees stay in the workspace, so the
+     * next run over the same FlowGraph starts from them and only repairs the links that its capacities, flows or
+     * deactivated Vertex and Edge broke.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace the algorithm runs in, already attached and loaded.
+     *
+     *\par Complexity
+     * O(V²E|f|) in the worst case, in which V is the number of vertex, E the number of edges of the Graph and |f| the
+     * max flow value; much faster in practice on sparse networks.
+     */
+    static void boykovKolmogorov(unsigned source, unsigned sink, SolverWorkspace& ws);
+    /**
+     * \brief Performs the maxFlow algorithm on the workspace's network with FIFO push-relabel, starting from the flow
+     * already in the workspace.
+     *
+     * The first phase only discharges vertices that can still reach the sink and ends with the max flow value at the
+     * sink. The second phase returns the excess left in the other vertices to the source, so the result is a flow.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace the algorithm runs in, already attached and loaded.
+     *
+     *\par Complexity
+     * O(V³) in which V is the number of vertex of the Graph.
+     */
+    static void pushRelabel(unsigned source, unsigned sink, SolverWorkspace& ws);
+    /**
+     * \brief Performs the maxFlow algorithm on the workspace's network with a lock-free push-relabel that runs on
+     * ws.threads threads, starting from the flow already in the workspace.
+     *
+     * Every thread owns a contiguous range of Vertex IDs and pushes each of its active vertices to its lowest
+     * residual neighbour, or relabels it; flows and excesses are updated with atomic additions. The threads meet at a
+     * barrier after every sweep, where the global relabel heuristic runs. The pushes, relabels and time spent by each
+     * thread are left in ws.threadWork.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace the algorithm runs in, already attached and loaded.
+     *
+     *\par Complexity
+     * O(V²E) work in which V is the number of vertex and E the number of edges of the Graph, spread over the threads.
+     */
+    static void parallelPushRelabel(unsigned source, unsigned sink, SolverWorkspace& ws);
     /**
      * \brief Iteratively finds augment paths from the given source and subtracts their bottleneck flow until the source's outgoing flow is zero.
      *
      * @param source The source vertex.
      * @param sink The sink vertex.
      * @param network The network Graph in which to perform the maxFlow.
+     * @param ws The workspace the algorithm runs in.
      *
      *\par Complexity
      * O(VE²) in which V is the number of vertex and E the number of edges of the Graph.
      */
-    static void reverseMaxFlow(const std::string& source, const std::string& sink, Graph* network);
-    /********************** MaxFlow List ****************************/
+    static void reverseMaxFlow(const std::string& source, const std::string& sink, Graph* network, SolverWorkspace& ws);
     /**
-     * \brief Performs the maxFlow algorithm on the provided network Graph using the edmondsKarp algorithm and saves the augmentation paths that were used.
+     * \brief Iteratively finds augment paths from the given source and subtracts their bottleneck flow until the source's outgoing flow is zero.
      *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
      * @param network The network Graph in which to perform the maxFlow.
+     * @param ws The workspace the algorithm runs in.
      *
      *\par Complexity
      * O(VE²) in which V is the number of vertex and E the number of edges of the Graph.
      */
-    void maxFlowWithList(Graph* network);
+    static void reverseMaxFlow(unsigned source, unsigned sink, Graph* network, SolverWorkspace& ws);
+    /********************** Decremental deletion ****************************/
     /**
-     * \brief Auxiliary function used by maxFlowWithList to augment the path from source to target with a value, saving the path.
+     * \brief Deletes the given reservoir from the given network Graph, updating the network's flow without doing maxflow from scratch.
      *
-     * @param source The source vertex.
-     * @param target The target vertex.
-     * @param cf The value to augment the path with.
-     */
-    void augmentPathList(Vertex* source, Vertex* target, double cf);
-    /**
-     * \brief Removes the given paths from the currently used augmentation paths, updating the network.
+     * Only the flow crossing the reservoir is cancelled, back to the source and forward to the sink, before augmenting again.
      *
-     * @param pathSet The set of indexes of the paths to remove.
+     * @param reservoir The reservoir to delete.
+     * @param network The network Graph to remove the reservoir from, holding a max flow.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to augment after the cancellation.
      *
      * \par Complexity
-     * O(NL) in which N is the number of paths to delete and L is the length of the longest path to delete.
+     * O(F + A) in which F is the number of edges carrying the cancelled flow and A the cost of the engine for
+     * augmenting back what can still reach the sink, which only depends on the part of the network that changed.
      */
-    void resetPaths(const std::unordered_set<int>& pathSet);
+    static void deleteReservoir(const std::string& reservoir, Graph* network, SolverWorkspace& ws,
+                                MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
     /**
      * \brief Deletes the given reservoir from the given network Graph, updating the network's flow without doing maxflow from scratch.
      *
-     * @param reservoir The reservoir to delete.
-     * @param network The network Graph to remove the reservoir from.
+     * Only the flow crossing the reservoir is cancelled, back to the source and forward to the sink, before augmenting again.
+     *
+     * @param reservoir The ID of the reservoir to delete.
+     * @param network The network Graph to remove the reservoir from, holding a max flow.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to augment after the cancellation.
      *
      * \par Complexity
-     * O(NL + VE²) where NL is the complexity of removing the used augmentation paths from the reservoir and VE^2 is the complexity of updating the existing network flow.
+     * O(F + A) in which F is the number of edges carrying the cancelled flow and A the cost of the engine for
+     * augmenting back what can still reach the sink, which only depends on the part of the network that changed.
      */
-    void deleteReservoir(const std::string& reservoir, Graph* network);
+    static void deleteReservoir(unsigned reservoir, Graph* network, SolverWorkspace& ws,
+                                MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
     /**
      * \brief Deletes the given station from the given network Graph, updating the network's flow without doing maxflow from scratch.
      *
+     * Only the flow crossing the station is cancelled, back to the source and forward to the sink, before augmenting again.
+     *
      * @param station The station to delete.
-     * @param network The network Graph to remove the reservoir from.
+     * @param network The network Graph to remove the station from, holding a max flow.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to augment after the cancellation.
+     *
+     * \par Complexity
+     * O(F + A) in which F is the number of edges carrying the cancelled flow and A the cost of the engine for
+     * augmenting back what can still reach the sink, which only depends on the part of the network that changed.
+     */
+    static void deleteStation(const std::string& station, Graph* network, SolverWorkspace& ws,
+                              MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
+    /**
+     * \brief Deletes the given station from the given network Graph, updating the network's flow without doing maxflow from scratch.
+     *
+     * Only the flow crossing the station is cancelled, back to the source and forward to the sink, before augmenting again.
+     *
+     * @param station The ID of the station to delete.
+     * @param network The network Graph to remove the station from, holding a max flow.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to augment after the cancellation.
      *
      * \par Complexity
-     * O(NL + VE²) where NL is the complexity of removing the used augmentation paths containing the given station and VE^2 is the complexity of updating the existing network flow.
+     * O(F + A) in which F is the number of edges carrying the cancelled flow and A the cost of the engine for
+     * augmenting back what can still reach the sink, which only depends on the part of the network that changed.
      */
-    void deleteStation(const std::string& station, Graph* network);
+    static void deleteStation(unsigned station, Graph* network, SolverWorkspace& ws,
+                              MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
     /**
      * \brief Deletes the given pipe from the given network Graph, updating the network's flow without doing maxflow from scratch.
      *
+     * Only the flow crossing the pipe is cancelled, back to the source and forward to the sink, before augmenting again.
+     *
      * @param source The source vertex of the pipe to delete.
      * @param dest The destination vertex of the pipe to delete.
-     * @param network The network Graph to remove the pipe from.
+     * @param network The network Graph to remove the pipe from, holding a max flow.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to augment after the cancellation.
+     *
+     * \par Complexity
+     * O(F + A) in which F is the number of edges carrying the cancelled flow and A the cost of the engine for
+     * augmenting back what can still reach the sink, which only depends on the part of the network that changed.
+     */
+    static void deletePipe(const std::string& source, const std::string& dest, Graph* network, SolverWorkspace& ws,
+                           MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
+    /**
+     * \brief Deletes the given pipe from the given network Graph, updating the network's flow without doing maxflow from scratch.
+     *
+     * Only the flow crossing the pipe is cancelled, back to the source and forward to the sink, before augmenting again.
+     *
+     * @param source The ID of the source vertex of the pipe to delete.
+     * @param dest The ID of the destination vertex of the pipe to delete.
+     * @param network The network Graph to remove the pipe from, holding a max flow.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to augment after the cancellation.
      *
      * \par Complexity
-     * O(NL + VE²) where NL is the complexity of removing the used augmentation paths containing the given pipe and VE^2 is the complexity of updating the existing network flow.
+     * O(F + A) in which F is the number of edges carrying the cancelled flow and A the cost of the engine for
+     * augmenting back what can still reach the sink, which only depends on the part of the network that changed.
      */
-    void deletePipe(const std::string& source, const std::string& dest, Graph* network);
+    static void deletePipe(unsigned source, unsigned dest, Graph* network, SolverWorkspace& ws,
+                           MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
     /**
-     * \brief Prepares the given network for reliability testing initializing its flow and used augmentation paths by calling maxFlowWithLists.
+     * \brief Removes the flow crossing the given Edge from the max flow in the workspace and augments again, without
+     * touching the Graph. The Edge and Vertex being removed must already be inactive in the workspace.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace holding a max flow.
+     * @param cut The IDs of the Edge that stop carrying flow.
+     * @param engine The algorithm used to augment after the cancellation.
+     *
+     * \par Complexity
+     * O(F + A) in which F is the number of edges carrying the cancelled flow and A the cost of the engine for
+     * augmenting back what can still reach the sink.
+     */
+    static void removeCut(unsigned source, unsigned sink, SolverWorkspace& ws, const std::vector<unsigned>& cut,
+                          MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
+    /**
+     * \brief Prepares the given network for reliability testing by computing its max flow from scratch, which the
+     * deletions then update.
      *
      * @param network The network Graph that will be tested.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm to use, Edmonds-Karp by default.
+     *
+     * \par Complexity
+     * The complexity of the max flow engine.
+     */
+    static void reliabilityPrep(Graph* network, SolverWorkspace& ws, MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
+    /**
+     * \brief Checks if removing the given Edge from the max flow in the workspace keeps the flow of every City, by
+     * rerouting their flow without passing through the sink. The Edge and Vertex being removed must already be
+     * inactive in the workspace, whose flow is left changed.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace holding a max flow.
+     * @param cut The IDs of the Edge that stop carrying flow.
+     * @return True if the removal cannot change the flow of any City, false if it has to be solved.
+     *
+     * \par Complexity
+     * O(V + PE) in which V is the number of vertex, E the number of edges of the Graph and P the number of paths
+     * needed to reroute the flow.
+     */
+    static bool isCutNeutral(unsigned source, unsigned sink, SolverWorkspace& ws, const std::vector<unsigned>& cut);
+    /**
+     * \brief Checks, without solving, if removing the given Vertex keeps the flow of every City of a max flow.
+     *
+     * It does when no flow crosses the Vertex, or when all of its flow can be rerouted from the source to the same
+     * vertices through the residual slack of other routes, without passing through the sink.
+     *
+     * @param network The network Graph, with the Vertex still active.
+     * @param ws The workspace the check runs in.
+     * @param baseline The max flow of the network before the removal, indexed by Edge ID.
+     * @param removed The Vertex that would be removed.
+     * @return True if the removal cannot change the flow of any City, false if it has to be solved.
      *
      * \par Complexity
-     * O(VE²) The complexity of maxFlowWithLists.
+     * O(V + E) to load the workspace, plus O(PE) when flow crosses the Vertex, in which V is the number of vertex, E
+     * the number of edges of the Graph and P the number of paths needed to reroute the flow.
      */
-    void reliabilityPrep(Graph* network);
+    static bool isRemovalNeutral(Graph* network, SolverWorkspace& ws, const std::vector<double>& baseline,
+                                 Vertex* removed);
+    /**
+     * \brief Checks, without solving, if removing the given pipe (and its reverse) keeps the flow of every City of a
+     * max flow.
+     *
+     * @param network The network Graph, with the pipe still active.
+     * @param ws The workspace the check runs in.
+     * @param baseline The max flow of the network before the removal, indexed by Edge ID.
+     * @param pipe The pipe that would be removed.
+     * @return True if the removal cannot change the flow of any City, false if it has to be solved.
+     *
+     * \par Complexity
+     * O(V + E) to load the workspace, plus O(PE) when the pipe carries flow, in which V is the number of vertex, E
+     * the number of edges of the Graph and P the number of paths needed to reroute the flow.
+     */
+    static bool isRemovalNeutral(Graph* network, SolverWorkspace& ws, const std::vector<double>& baseline, Edge* pipe);
     /**
      * \brief Performs the maxFlow algorithm on the provided network Graph using Dijkstra's SSSP algorithm to find the emptiest augmentation path.
      *
+     * A path costs the sum of 1 / (capacity - flow) of its edges, and augmenting only raises those costs or removes
+     * edges, so the cost from each vertex to the sink, computed once by a backward Dijkstra, stays a lower bound for
+     * the whole run. Every search is an A* guided by those bounds that stops once the sink is settled, and tightens
+     * the bounds of the vertices it settled; the vertices that cannot reach the sink are never visited.
+     *
      * @param network The network Graph in which to perform the maxFlow.
      * @param source The source vertex.
      * @param sink The sink vertex.
+     * @param ws The workspace the algorithm runs in.
      *
      *\par Complexity
-     * O(VE²log(V)) in which V is the number of vertex and E the number of edges of the Graph.
+     * O(VE²log(V)) in the worst case, in which V is the number of vertex and E the number of edges of the Graph; a
+     * search usually settles only the vertices around the path it finds.
      */
-    static void balancedMaxFlow(Graph *network, const std::string &source, const std::string &sink);
+    static void balancedMaxFlow(Graph *network, const std::string &source, const std::string &sink, SolverWorkspace& ws);
     /**
-     * \brief Gets the current paths of the network.
+     * \brief Performs the maxFlow algorithm on the provided network Graph using Dijkstra's SSSP algorithm to find the emptiest augmentation path.
      *
-     * @return The current paths of the network.
-     */
-    std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge*>>>> getPaths();
-    /**
-     * \brief Updates the current paths of the network.
+     * A path costs the sum of 1 / (capacity - flow) of its edges, and augmenting only raises those costs or removes
+     * edges, so the cost from each vertex to the sink, computed once by a backward Dijkstra, stays a lower bound for
+     * the whole run. Every search is an A* guided by those bounds that stops once the sink is settled, and tightens
+     * the bounds of the vertices it settled; the vertices that cannot reach the sink are never visited.
      *
-     * @param paths The new paths to set in the network.
-     * @param network The network to update the paths of.
+     * @param network The network Graph in which to perform the maxFlow.
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace the algorithm runs in.
+     *
+     *\par Complexity
+     * O(VE²log(V)) in the worst case, in which V is the number of vertex and E the number of edges of the Graph; a
+     * search usually settles only the vertices around the path it finds.
      */
-    void setPaths(std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge*>>>> paths, Graph* network);
+    static void balancedMaxFlow(Graph *network, unsigned source, unsigned sink, SolverWorkspace& ws);
      /**
      * \brief Deletes the given Reservoir from the given network Graph, updating the network's flow.
      *
      * @param reservoir The Reservoir to delete.
      * @param network The network Graph to remove the reservoir from.
+     * @param ws The workspace the algorithm runs in.
+     *
+     * \par Complexity
+     * O(VE²)
+     */
+    void deleteReservoirScratch(const std::string &reservoir, Graph *network, SolverWorkspace& ws);
+    /**
+     * \brief Deletes the given Reservoir from the given network Graph, updating the network's flow.
+     *
+     * @param reservoir The ID of the Reservoir to delete.
+     * @param network The network Graph to remove the reservoir from.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to recompute the max flow.
      *
      * \par Complexity
      * O(VE²)
      */
-    void deleteReservoirScratch(const std::string &reservoir, Graph *network);
+    void deleteReservoirScratch(unsigned reservoir, Graph *network, SolverWorkspace& ws, MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
     /**
      * \brief Deletes the given Station from the given network Graph, updating the network's flow.
      *
      * @param station The Station to delete.
      * @param network The network Graph to remove the Reservoir from.
+     * @param ws The workspace the algorithm runs in.
+     *
+     * \par Complexity
+     * O(VE²)
+     */
+    void deleteStationScratch(const std::string &station, Graph *network, SolverWorkspace& ws);
+    /**
+     * \brief Deletes the given Station from the given network Graph, updating the network's flow.
+     *
+     * @param station The ID of the Station to delete.
+     * @param network The network Graph to remove the Reservoir from.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to recompute the max flow.
      *
      * \par Complexity
      * O(VE²)
      */
-    void deleteStationScratch(const std::string &station, Graph *network);
+    void deleteStationScratch(unsigned station, Graph *network, SolverWorkspace& ws, MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
       /**
      * \brief Deletes the given pipe from the given network Graph, updating the network's flow.
      *
      * @param source The source vertex of the Pipe to delete.
      * @param dest The destination vertex of the pipe to delete.
      * @param network The network Graph to remove the pipe from.
+     * @param ws The workspace the algorithm runs in.
+     *
+     * \par Complexity
+     * O(VE²)
+     */
+    void deletePipeScratch(const std::string &source, const std::string &dest, Graph *network, SolverWorkspace& ws);
+    /**
+     * \brief Deletes the given pipe from the given network Graph, updating the network's flow.
+     *
+     * @param source The ID of the source vertex of the Pipe to delete.
+     * @param dest The ID of the destination vertex of the pipe to delete.
+     * @param network The network Graph to remove the pipe from.
+     * @param ws The workspace the algorithm runs in.
+     * @param engine The algorithm used to recompute the max flow.
      *
      * \par Complexity
      * O(VE²)
      */
-    void deletePipeScratch(const std::string &source, const std::string &dest, Graph *network);
+    void deletePipeScratch(unsigned source, unsigned dest, Graph *network, SolverWorkspace& ws, MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP);
 };
 
 
@@ -3,6 +3,8 @@
 #include <sstream>
 #include <iomanip>
 #include <map>
+#include <fstream>
+#include <cmath>
 #include "ColorPrint.h"
 
 using namespace std;
@@ -68,6 +70,21 @@ char Menu::readOption(int n){
     return option[0];
 }
 
+double Menu::readNumber(double min, double max, double fallback) {
+    string number;
+    getline(cin, number);
+    if (number.empty()) return fallback;
+    char* end = nullptr;
+    double value = strtod(number.c_str(), &end);
+    while (*end != '\0' || !std::isfinite(value) || value < min || value > max) {
+        ColorPrint("red", "Invalid number, please try again\n");
+        getline(cin, number);
+        if (number.empty()) return fallback;
+        value = strtod(number.c_str(), &end);
+    }
+    return value;
+}
+
 string Menu::readCityCode(){
     string code;
     ColorPrint("cyan", "City code (");
@@ -308,9 +325,7 @@ void Menu::run() {
                 reliabilityMenu();
                 break;
             case '4':
-                waterSupply.balancingViaMinCost();
-                printNetworkStatistics();
-                pressEnterToContinue();
+                balanceMenu();
                 break;
             case '5':
                 settings();
@@ -331,8 +346,26 @@ void Menu::settings() {
     ColorPrint("cyan", "2. ");
     ColorPrint("white", "Change display mode\n");
     ColorPrint("cyan", "3. ");
+    ColorPrint("white", "Change data set\n");
+    ColorPrint("cyan", "4. ");
+    ColorPrint("white", "Change max flow engine ");
+    switch (waterSupply.getEngine()) {
+        case MaxFlowEngine::EDMONDS_KARP: ColorPrint("yellow", "(Edmonds-Karp)\n"); break;
+        case MaxFlowEngine::DINIC: ColorPrint("yellow", "(Dinic)\n"); break;
+        case MaxFlowEngine::PUSH_RELABEL: ColorPrint("yellow", "(Push-relabel)\n"); break;
+        case MaxFlowEngine::PARALLEL_PUSH_RELABEL: ColorPrint("yellow", "(Parallel push-relabel)\n"); break;
+        case MaxFlowEngine::CAPACITY_SCALING: ColorPrint("yellow", "(Capacity scaling)\n"); break;
+        case MaxFlowEngine::BOYKOV_KOLMOGOROV: ColorPrint("yellow", "(Boykov-Kolmogorov)\n"); break;
+    }
+    ColorPrint("cyan", "5. ");
+    ColorPrint("white", "Change min-cost engine ");
+    switch (waterSupply.getMinCostEngine()) {
+        case MinCostEngine::SUCCESSIVE_SHORTEST_PATHS: ColorPrint("yellow", "(Successive shortest paths)\n"); break;
+        case MinCostEngine::NETWORK_SIMPLEX: ColorPrint("yellow", "(Network simplex)\n"); break;
+    }
+    ColorPrint("cyan", "6. ");
     ColorPrint("red", "Cancel\n");
-    switch (readOption(3)) {
+    switch (readOption(6)) {
         case '1':
             ColorPrint::swapColorMode();
             ColorPrint("cyan", ColorPrint::colorMode ? "Color mode enabled\n" : "Color mode disabled\n");
@@ -340,6 +373,85 @@ void Menu::settings() {
         case '2':
             changeDisplayMode();
             break;
+        case '3':
+            init();
+            break;
+        case '4':
+            changeMaxFlowEngine();
+            break;
+        case '5':
+            changeMinCostEngine();
+            break;
+    }
+}
+
+void Menu::changeMaxFlowEngine() {
+    ColorPrint("blue", "Select option:\n");
+    ColorPrint("cyan", "1. ");
+    ColorPrint("white", "Edmonds-Karp\n");
+    ColorPrint("cyan", "2. ");
+    ColorPrint("white", "Dinic\n");
+    ColorPrint("cyan", "3. ");
+    ColorPrint("white", "Push-relabel\n");
+    ColorPrint("cyan", "4. ");
+    ColorPrint("white", "Parallel push-relabel\n");
+    ColorPrint("cyan", "5. ");
+    ColorPrint("white", "Capacity scaling\n");
+    ColorPrint("cyan", "6. ");
+    ColorPrint("white", "Boykov-Kolmogorov\n");
+    ColorPrint("cyan", "7. ");
+    ColorPrint("red", "Cancel\n");
+    switch (readOption(7)) {
+        case '1':
+            waterSupply.setEngine(MaxFlowEngine::EDMONDS_KARP);
+            ColorPrint("cyan", "Using Edmonds-Karp\n");
+            break;
+        case '2':
+            waterSupply.setEngine(MaxFlowEngine::DINIC);
+            ColorPrint("cyan", "Using Dinic\n");
+            break;
+        case '3':
+            waterSupply.setEngine(MaxFlowEngine::PUSH_RELABEL);
+            ColorPrint("cyan", "Using push-relabel\n");
+            break;
+        case '4':
+            waterSupply.setEngine(MaxFlowEngine::PARALLEL_PUSH_RELABEL);
+            ColorPrint("cyan", "Using parallel push-relabel\n");
+            break;
+        case '5':
+            waterSupply.setEngine(MaxFlowEngine::CAPACITY_SCALING);
+            ColorPrint("cyan", "Using capacity scaling\n");
+            break;
+        case '6':
+            waterSupply.setEngine(MaxFlowEngine::BOYKOV_KOLMOGOROV);
+            ColorPrint("cyan", "Using Boykov-Kolmogorov\n");
+            break;
+        case '7':
+            settings();
+            break;
+    }
+}
+
+void Menu::changeMinCostEngine() {
+    ColorPrint("blue", "Select option:\n");
+    ColorPrint("cyan", "1. ");
+    ColorPrint("white", "Successive shortest paths\n");
+    ColorPrint("cyan", "2. ");
+    ColorPrint("white", "Network simplex\n");
+    ColorPrint("cyan", "3. ");
+    ColorPrint("red", "Cancel\n");
+    switch (readOption(3)) {
+        case '1':
+            waterSupply.setMinCostEngine(MinCostEngine::SUCCESSIVE_SHORTEST_PATHS);
+            ColorPrint("cyan", "Using successive shortest paths\n");
+            break;
+        case '2':
+            waterSupply.setMinCostEngine(MinCostEngine::NETWORK_SIMPLEX);
+            ColorPrint("cyan", "Using network simplex\n");
+            break;
+        case '3':
+            settings();
+            break;
     }
 }
 
@@ -405,8 +517,8 @@ void Menu::getCityInfo() {
             break;
         case '4':
             ColorPrint("blue", "Code | City | Demand | Population\n");
-            for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-                printCity(waterSupply.getCity("C_" + to_string(i)));
+            for(unsigned id: waterSupply.getCityIds()) {
+                printCity(waterSupply.getCity(id));
             }
             pressEnterToContinue();
             return;
@@ -476,8 +588,8 @@ void Menu::getReservoirInfo() {
             return;
         case '5':
             ColorPrint("blue", "Code | Reservoir | Municipality | Max Delivery \n");
-            for (int i = 1; i <= waterSupply.getReservoirs().size(); i++) {
-                printReservoir(waterSupply.getReservoir("R_" + to_string(i)));
+            for (unsigned id: waterSupply.getReservoirIds()) {
+                printReservoir(waterSupply.getReservoir(id));
             }
             pressEnterToContinue();
             return;
@@ -593,13 +705,13 @@ void Menu::init() {
             string cities, pipes, reservoirs, stations;
             getline(cin, cities);
             ColorPrint("cyan", "Pipes file path: \n");
-            ColorPrint("white", "Format - Service_Point_A,Service_Point_B,Capacity,Direction\n");
+            ColorPrint("white", "Format - Service_Point_A,Service_Point_B,Capacity,Direction[,Failure Probability]\n");
             getline(cin, pipes);
             ColorPrint("cyan", "Reservoirs file path: \n");
-            ColorPrint("white", "Format - Reservoir,Municipality,Id,Code,Maximum Delivery (m3/sec)\n");
+            ColorPrint("white", "Format - Reservoir,Municipality,Id,Code,Maximum Delivery (m3/sec)[,Failure Probability]\n");
             getline(cin, reservoirs);
             ColorPrint("cyan", "Stations file path: \n");
-            ColorPrint("white", "Format - Id,Code\n");
+            ColorPrint("white", "Format - Id,Code[,Failure Probability]\n");
             getline(cin, stations);
             waterSupply.load(cities, reservoirs, pipes, stations);
     }
@@ -622,6 +734,7 @@ void Menu::getMaxFlowOp() {
         case '1':
             waterSupply.maxFlow();
             printCitiesFlow();
+            if (waterSupply.getEngine() == MaxFlowEngine::PARALLEL_PUSH_RELABEL) printThreadWork();
             pressEnterToContinue();
             break;
         case '2':
@@ -631,7 +744,7 @@ void Menu::getMaxFlowOp() {
             getMaxFlowExcessOp();
             break;
         case '4':
-            MaxFlow::balancedMaxFlow(waterSupply.getNetwork(), "src", "sink");
+            MaxFlow::balancedMaxFlow(waterSupply.getNetwork(), "src", "sink", waterSupply.getWorkspace());
             printNetworkStatistics();
             pressEnterToContinue();
             break;
@@ -663,7 +776,7 @@ void Menu::MaxFlowWithPrioritizedCities(){
         case '2':
         {
             vector<string> citiesByPopulation;
-            auto cities = waterSupply.getCities();
+            const auto& cities = waterSupply.getCities();
             citiesByPopulation.reserve(cities.size());
             for(const auto& c : cities) citiesByPopulation.push_back(c.first);
 
@@ -678,11 +791,11 @@ void Menu::MaxFlowWithPrioritizedCities(){
             if (option != '3') {
                 bool ascending = option == '1';
                 ascending ? std::sort(citiesByPopulation.begin(), citiesByPopulation.end(),
-                                      [cities](const string &s1, const string &s2) {
+                                      [&cities](const string &s1, const string &s2) {
                                           return cities.at(s1).getPopulation() < cities.at(s2).getPopulation();
                                       })
                           : std::sort(citiesByPopulation.rbegin(), citiesByPopulation.rend(),
-                                      [cities](const string &s1, const string &s2) {
+                                      [&cities](const string &s1, const string &s2) {
                                           return cities.at(s1).getPopulation() < cities.at(s2).getPopulation();
                                       });
 
@@ -693,14 +806,19 @@ void Menu::MaxFlowWithPrioritizedCities(){
         }
             break;
         case '3':
+        {
             ColorPrint("cyan", "\nCity - Flow\n");
-            for(int i = 1; i < waterSupply.getCities().size(); i++){
-                string city = "C_" + to_string(i);
-                waterSupply.optimalCityMaxFlow({city});
-                ostringstream tmp; tmp << left << setw(4) << city << "- " << waterSupply.computeCityFlow(city) << "\n";
+            const vector<double>& supply = waterSupply.getMaxCitySupply();
+            const vector<unsigned>& cityIds = waterSupply.getCityIds();
+            for(unsigned i = 0; i < cityIds.size(); i++){
+                ostringstream tmp; tmp << left << setw(4) << waterSupply.getNetwork()->getInfo(cityIds[i]) << "- " << (int)round(supply[i]) << "\n";
                 ColorPrint("white", tmp.str());
             }
+            ostringstream solves;
+            solves << "\n" << waterSupply.getMaxCitySupplySolves() << " max flow solves for " << cityIds.size() << " Cities\n";
+            ColorPrint("cyan", solves.str());
             pressEnterToContinue();
+        }
             break;
         case '4':
             getMaxFlowOp();
@@ -754,10 +872,9 @@ void Menu::getMaxFlowExcessOp() {
 void Menu::checkDeactivatedReservoirs(){
     ColorPrint("blue", "Deactivated Reservoirs:\n");
     bool empty = true;
-    for(int i = 1; i <= waterSupply.getReservoirs().size(); i++) {
-        auto code = "R_" + to_string(i);
-        if(!waterSupply.getNetwork()->findVertex(code)->checkActive()){
-            ColorPrint("white", code + "\n");
+    for(unsigned id: waterSupply.getReservoirIds()) {
+        if(!waterSupply.getNetwork()->findVertex(id)->checkActive()){
+            ColorPrint("white", waterSupply.getNetwork()->getInfo(id) + "\n");
             empty = false;
         }
     }
@@ -779,10 +896,9 @@ void Menu::checkDeactivatedReservoirs(){
 void Menu::checkDeactivatedStations(){
     ColorPrint("blue", "Deactivated Stations:\n");
     bool empty = true;
-    for(int i = 1; i <= waterSupply.getStations().size(); i++) {
-        auto code = "PS_" + to_string(i);
-        if(!waterSupply.getNetwork()->findVertex(code)->checkActive()){
-            ColorPrint("white", code + "\n");
+    for(unsigned id: waterSupply.getStationIds()) {
+        if(!waterSupply.getNetwork()->findVertex(id)->checkActive()){
+            ColorPrint("white", waterSupply.getNetwork()->getInfo(id) + "\n");
             empty = false;
         }
     }
@@ -805,8 +921,8 @@ void Menu::checkDeactivatedStations(){
 void Menu::checkDeactivatedPipes(){
     ColorPrint("blue", "Deactivated Pipes:\n");
     vector<pair<string,string>> pipes;
-    for(const auto& v : waterSupply.getNetwork()->getVertexSet()){
-        for(auto adj : v.second->getAdj()){
+    for(auto v : waterSupply.getNetwork()->getVertexSet()){
+        for(auto adj : v->getAdj()){
             if(!adj->checkActive()) pipes.emplace_back(adj->getOrig()->getInfo(), adj->getDest()->getInfo());
         }
     }
@@ -888,6 +1004,51 @@ void Menu::reliabilityMenu() {
     }
 }
 
+void Menu::balanceMenu() {
+    ColorPrint("blue", "Select option:\n");
+    ColorPrint("cyan", "1. ");
+    ColorPrint("white", "Through the widest pipes (min-cost flow)\n");
+    ColorPrint("cyan", "2. ");
+    ColorPrint("white", "Minimize the variance (convex cost flow)\n");
+    ColorPrint("cyan", "3. ");
+    ColorPrint("red", "Cancel \n");
+    cin.sync();
+    switch (readOption(3)) {
+        case '1': {
+            double cost = waterSupply.balancingViaMinCost();
+            printNetworkStatistics();
+            ColorPrint("cyan", "\nCost: ");
+            ColorPrint("white", convertDouble(cost) + "\n");
+            if (waterSupply.getMinCostEngine() == MinCostEngine::NETWORK_SIMPLEX) {
+                const SimplexStats& stats = waterSupply.getSimplexStats();
+                ColorPrint("cyan", "Pivots: ");
+                ColorPrint("white", to_string(stats.pivots));
+                ColorPrint("cyan", "  Degenerate: ");
+                ColorPrint("white", to_string(stats.degenerate));
+                ColorPrint("yellow", stats.warmStart ? "  (warm start)\n" : "  (cold start)\n");
+            }
+            pressEnterToContinue();
+            break;
+        }
+        case '2': {
+            VarianceBalance report = waterSupply.balancingViaConvexCost();
+            printNetworkStatistics();
+            ColorPrint("cyan", "\nVariance before balancing: ");
+            ColorPrint("white", convertDouble(report.initialVariance) + "\n");
+            ColorPrint("cyan", "Rounds: ");
+            ColorPrint("white", to_string(report.rounds));
+            ColorPrint("cyan", "  Scaling phases: ");
+            ColorPrint("white", to_string(report.work.phases));
+            ColorPrint("cyan", "  Pushes: ");
+            ColorPrint("white", to_string(report.work.pushes));
+            ColorPrint("cyan", "  Relabels: ");
+            ColorPrint("white", to_string(report.work.relabels) + "\n");
+            pressEnterToContinue();
+            break;
+        }
+    }
+}
+
 void Menu::auxReliabilityList() {
     ColorPrint("blue", "Select option:\n");
     ColorPrint("cyan", "1. ");
@@ -895,9 +1056,13 @@ void Menu::auxReliabilityList() {
     ColorPrint("cyan", "2. ");
     ColorPrint("white", "Using previous flow\n");
     ColorPrint("cyan", "3. ");
+    ColorPrint("white", "In parallel (N-1 contingency)\n");
+    ColorPrint("cyan", "4. ");
+    ColorPrint("white", "Monte Carlo simulation\n");
+    ColorPrint("cyan", "5. ");
     ColorPrint("red", "Cancel \n");
     cin.sync();
-    switch (readOption(3)) {
+    switch (readOption(5)) {
         case '1':
             listReliabilityScratch();
             break;
@@ -905,6 +1070,12 @@ void Menu::auxReliabilityList() {
             listReliabilityTesting();
             break;
         case '3':
+            listContingency();
+            break;
+        case '4':
+            monteCarloSimulation();
+            break;
+        case '5':
             reliabilityMenu();
             break;
     }
@@ -913,7 +1084,7 @@ void Menu::auxReliabilityList() {
 void Menu::auxReliability() {
     vector<std::string> ResStat;
     vector<pair<string, string>> pipes;
-    maxFlow.reliabilityPrep(waterSupply.getNetwork());
+    maxFlow.reliabilityPrep(waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
     reliabilityTesting(ResStat, pipes);
     if (ResStat.empty() && pipes.empty()) return;
     ColorPrint("blue", "Do you wish to make your changes permanent?\n");
@@ -952,11 +1123,10 @@ void Menu::reliabilityTesting(vector<std::string>& resStat, vector<pair<string,
         case '1':
             res = readReservoirCode();
             if (!res.empty()) {
-                for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-                    auto city = waterSupply.getCity("C_" + to_string(i));
-                    citiesPrevFlow.push_back(waterSupply.computeCityFlow(city.getCode()));
+                for(unsigned id: waterSupply.getCityIds()) {
+                    citiesPrevFlow.push_back(waterSupply.computeCityFlow(id));
                 }
-                maxFlow.deleteReservoir(res, waterSupply.getNetwork());
+                maxFlow.deleteReservoir(res, waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
                 resStat.push_back(res);
             }
             else end = false;
@@ -964,11 +1134,10 @@ void Menu::reliabilityTesting(vector<std::string>& resStat, vector<pair<string,
         case '2':
             res = readStationCode();
             if (!res.empty()) {
-                for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-                    auto city = waterSupply.getCity("C_" + to_string(i));
-                    citiesPrevFlow.push_back(waterSupply.computeCityFlow(city.getCode()));
+                for(unsigned id: waterSupply.getCityIds()) {
+                    citiesPrevFlow.push_back(waterSupply.computeCityFlow(id));
                 }
-                maxFlow.deleteStation(res, waterSupply.getNetwork());
+                maxFlow.deleteStation(res, waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
                 resStat.push_back(res);
             }
             else end = false;
@@ -976,12 +1145,11 @@ void Menu::reliabilityTesting(vector<std::string>& resStat, vector<pair<string,
         case '3':
             pipe =  readPipeCodes();
             if (!pipe.first.empty() && !pipe.second.empty()) {
-                for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-                    auto city = waterSupply.getCity("C_" + to_string(i));
-                    citiesPrevFlow.push_back(waterSupply.computeCityFlow(city.getCode()));
+                for(unsigned id: waterSupply.getCityIds()) {
+                    citiesPrevFlow.push_back(waterSupply.computeCityFlow(id));
                 }
                 pipes.push_back(pipe);
-                maxFlow.deletePipe(pipe.first, pipe.second, waterSupply.getNetwork());
+                maxFlow.deletePipe(pipe.first, pipe.second, waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
             }
             else end = false;
             break;
@@ -1015,24 +1183,22 @@ void Menu::listReliabilityTesting() {
     cin.sync();
     vector<double> citiesPrevFlow;
     waterSupply.maxFlow();
-    for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-        auto city = waterSupply.getCity("C_" + to_string(i));
-        citiesPrevFlow.push_back(waterSupply.computeCityFlow(city.getCode()));
+    for(unsigned id: waterSupply.getCityIds()) {
+        citiesPrevFlow.push_back(waterSupply.computeCityFlow(id));
     }
-    maxFlow.reliabilityPrep(waterSupply.getNetwork());
-    std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge*>>>> paths = maxFlow.getPaths();
+    maxFlow.reliabilityPrep(waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
     string network = waterSupply.saveNetwork();
     switch(readOption(4)) {
         case '1':
-            removeReservoirs(paths, network, citiesPrevFlow);
+            removeReservoirs(network, citiesPrevFlow);
             pressEnterToContinue();
             break;
         case '2':
-            removeStations(paths, network, citiesPrevFlow);
+            removeStations(network, citiesPrevFlow);
             pressEnterToContinue();
             break;
         case '3':
-            removePipes(paths, network, citiesPrevFlow);
+            removePipes(network, citiesPrevFlow);
             pressEnterToContinue();
             break;
         case '4':
@@ -1054,21 +1220,21 @@ void Menu::listReliabilityScratch() {
     cin.sync();
     vector<double> citiesPrevFlow;
     waterSupply.maxFlow();
-    for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-        auto city = waterSupply.getCity("C_" + to_string(i));
-        citiesPrevFlow.push_back(waterSupply.computeCityFlow(city.getCode()));
+    for(unsigned id: waterSupply.getCityIds()) {
+        citiesPrevFlow.push_back(waterSupply.computeCityFlow(id));
     }
+    vector<double> baseline = waterSupply.getWorkspace().flow;
     switch(readOption(4)) {
         case '1':
-            removeReservoirsScratch(citiesPrevFlow);
+            removeReservoirsScratch(citiesPrevFlow, baseline);
             pressEnterToContinue();
             break;
         case '2':
-            removeStationsScratch(citiesPrevFlow);
+            removeStationsScratch(citiesPrevFlow, baseline);
             pressEnterToContinue();
             break;
         case '3':
-            removePipesScratch(citiesPrevFlow);
+            removePipesScratch(citiesPrevFlow, baseline);
             pressEnterToContinue();
             break;
         case '4':
@@ -1077,7 +1243,174 @@ void Menu::listReliabilityScratch() {
     }
 }
 
-void Menu::printCitiesFlow(vector<double> citiesPrevFlow) {
+vector<Outage> Menu::contingencyComponents(Contingency& contingency, char option) {
+    switch(option) {
+        case '1':
+            return contingency.reservoirOutages();
+        case '2':
+            return contingency.stationOutages();
+        case '3':
+            return contingency.pipeOutages();
+    }
+    vector<Outage> outages = contingency.reservoirOutages();
+    vector<Outage> more = contingency.stationOutages();
+    outages.insert(outages.end(), more.begin(), more.end());
+    more = contingency.pipeOutages();
+    outages.insert(outages.end(), more.begin(), more.end());
+    return outages;
+}
+
+void Menu::listContingency() {
+    ColorPrint("blue", "Select option:\n");
+    ColorPrint("cyan", "1. ");
+    ColorPrint("white", "List remove reservoirs\n");
+    ColorPrint("cyan", "2. ");
+    ColorPrint("white", "List remove stations\n");
+    ColorPrint("cyan", "3. ");
+    ColorPrint("white", "List remove pipes\n");
+    ColorPrint("cyan", "4. ");
+    ColorPrint("white", "List remove all components\n");
+    ColorPrint("cyan", "5. ");
+    ColorPrint("white", "List combined outages (N-k)\n");
+    ColorPrint("cyan", "6. ");
+    ColorPrint("red", "Cancel\n");
+    cin.sync();
+    Contingency contingency(waterSupply);
+    char option = readOption(6);
+    switch(option) {
+        case '5':
+            listCombinedOutages();
+            return;
+        case '6':
+            auxReliabilityList();
+            return;
+    }
+    vector<Outage> outages = contingencyComponents(contingency, option);
+    vector<OutageResult> results = contingency.evaluate(outages);
+    printContingency(outages, results, contingency.getThreads());
+    pressEnterToContinue();
+}
+
+void Menu::listCombinedOutages() {
+    ColorPrint("blue", "Which components can fail together?\n");
+    ColorPrint("cyan", "1. ");
+    ColorPrint("white", "Reservoirs\n");
+    ColorPrint("cyan", "2. ");
+    ColorPrint("white", "Stations\n");
+    ColorPrint("cyan", "3. ");
+    ColorPrint("white", "Pipes\n");
+    ColorPrint("cyan", "4. ");
+    ColorPrint("white", "All components\n");
+    cin.sync();
+    Contingency contingency(waterSupply);
+    vector<Outage> components = contingencyComponents(contingency, readOption(4));
+    ColorPrint("blue", "Maximum number of components failing together (1-4): \n");
+    unsigned k = readOption(4) - '0';
+    ofstream out("../output/Contingency.csv");
+    vector<NkLevel> levels = contingency.enumerate(components, k, out);
+    out.close();
+    ColorPrint("cyan", "\nSize - Combinations / Evaluated / Critical / Dominated / Without flow\n");
+    for (const NkLevel& level: levels) {
+        ostringstream line;
+        line << left << setw(4) << level.size << " - " << level.combinations << " / " << level.evaluated << " / "
+             << level.critical << " / " << level.dominated << " / " << level.idle;
+        ColorPrint("white", line.str());
+        if (level.sampled) ColorPrint("yellow", " (sampled)");
+        ColorPrint("white", "\n");
+    }
+    ostringstream line;
+    line << "\nEvaluated with " << contingency.getThreads() << " threads, results written to output/Contingency.csv\n";
+    ColorPrint("cyan", line.str());
+    pressEnterToContinue();
+}
+
+void Menu::monteCarloSimulation() {
+    Contingency contingency(waterSupply);
+    vector<Outage> components = contingencyComponents(contingency, '4');
+    ColorPrint("cyan", "Number of samples (");
+    ColorPrint("yellow", "empty for 10000");
+    ColorPrint("cyan", "): \n");
+    auto samples = (unsigned long) readNumber(1, 1e9, 10000);
+    ColorPrint("cyan", "Seed (");
+    ColorPrint("yellow", "empty for 0");
+    ColorPrint("cyan", "): \n");
+    contingency.setSeed((unsigned) readNumber(0, 4294967295.0, 0));
+    ColorPrint("cyan", "Failure probability of the components without one in the data set (");
+    ColorPrint("yellow", "empty for 0");
+    ColorPrint("cyan", "): \n");
+    double fallback = readNumber(0, 1, 0);
+    unsigned risky = 0;
+    for (Outage& component: components) {
+        if (component.failureProbability < 0) component.failureProbability = fallback;
+        if (component.failureProbability > 0) risky++;
+    }
+    if (risky == 0) {
+        ColorPrint("pink", "No component can fail, every City keeps its flow\n");
+        pressEnterToContinue();
+        return;
+    }
+    SimulationResult result = contingency.simulate(components, samples);
+    ColorPrint("cyan", "\nCity: Expected unmet demand +/- 95% margin (Demand) | Chance of losing water\n\n");
+    for (const CityRisk& risk: result.cities) {
+        const City& city = waterSupply.getCity(risk.city);
+        ostringstream line;
+        line << left << setw(6) << city.getCode() + ": ";
+        ColorPrint("blue", line.str());
+        ColorPrint(risk.expectedUnmet > 0 ? "red" : "green", convertDouble(risk.expectedUnmet, 2));
+        ColorPrint("white", " +/- " + convertDouble(risk.margin, 2));
+        ColorPrint("cyan", " (" + convertDouble(city.getDemand(), 0) + ")");
+        ColorPrint("white", " | " + convertDouble(100 * risk.lossProbability, 2) + "%\n");
+    }
+    ostringstream summary;
+    summary << "\nNetwork: " << convertDouble(result.expectedUnmet, 2) << " +/- " << convertDouble(result.margin, 2)
+            << " expected unmet demand\n" << result.samples << " samples of " << risky << " components that can fail, "
+            << result.solved << " repaired, " << contingency.getThreads() << " threads\n";
+    ColorPrint("cyan", summary.str());
+    pressEnterToContinue();
+}
+
+void Menu::printContingency(const vector<Outage>& outages, const vector<OutageResult>& results, unsigned threads) {
+    ColorPrint("cyan", "\nComponent: Altered City [Flow Difference](Flow / Demand) | ... {Deficit}\n\n");
+    unsigned skipped = 0;
+    for (unsigned i = 0; i < outages.size(); i++) {
+        ostringstream tmp;
+        tmp << left << setw(outages[i].vertices.empty() ? 16 : 6) << outages[i].name + ": ";
+        ColorPrint("blue", tmp.str());
+        if (!results[i].solved) skipped++;
+        int count = 0;
+        for (const AffectedCity& affected: results[i].affected) {
+            const City& city = waterSupply.getCity(affected.city);
+            printAffectedCity(city.getCode(), affected.flow, city.getDemand(), affected.delta, count);
+            count++;
+        }
+        if (!count) ColorPrint("pink", "(No changes of flow to any City)");
+        else ColorPrint("red", " {" + convertDouble(results[i].deficit, 0) + "}");
+        ColorPrint("white", "\n\n");
+    }
+    ostringstream line;
+    line << outages.size() << " outages evaluated with " << threads << " threads\n";
+    ColorPrint("cyan", line.str());
+    printSkippedSolves(skipped, outages.size());
+}
+
+void Menu::printSkippedSolves(unsigned skipped, unsigned total) {
+    ostringstream line;
+    line << skipped << " of " << total << " removals kept the flow of every City and were not solved\n";
+    ColorPrint("cyan", line.str());
+}
+
+void Menu::printThreadWork() {
+    const vector<SolverWorkspace::ThreadWork>& threadWork = waterSupply.getWorkspace().threadWork;
+    ColorPrint("cyan", "\nThread - Pushes / Relabels / Time (s)\n");
+    for (unsigned t = 0; t < threadWork.size(); t++) {
+        ostringstream line;
+        line << left << setw(6) << t << " - " << threadWork[t].pushes << " / " << threadWork[t].relabels << " / "
+             << threadWork[t].seconds << '\n';
+        ColorPrint("white", line.str());
+    }
+}
+
+void Menu::printCitiesFlow(const vector<double>& citiesPrevFlow) {
     ostringstream file;
     if (displayDemand) {
         ColorPrint("cyan", "\nCity - Flow / Demand\n");
@@ -1087,9 +1420,10 @@ void Menu::printCitiesFlow(vector<double> citiesPrevFlow) {
         ColorPrint("cyan", "\nCity - Flow\n");
         file << "City - Flow\n\n";
     }
-    for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-        auto city = waterSupply.getCity("C_" + to_string(i));
-        double flow = waterSupply.computeCityFlow(city.getCode());
+    const vector<unsigned>& cityIds = waterSupply.getCityIds();
+    for(unsigned i = 0; i < cityIds.size(); i++) {
+        const City& city = waterSupply.getCity(cityIds[i]);
+        double flow = waterSupply.computeCityFlow(cityIds[i]);
         ostringstream line;
         ostringstream flowDemand;
         if ((city.getDemand() < flow && displayOverflow) || (city.getDemand() > flow && displayUnderflow) || (city.getDemand() == flow && displayOnDemand)) {
@@ -1114,8 +1448,8 @@ void Menu::printCitiesFlow(vector<double> citiesPrevFlow) {
             line.str("");
             line.clear();
             if (!citiesPrevFlow.empty()) {
-                if(citiesPrevFlow[i-1] != flow) {
-                    line << " (Previous flow : " << citiesPrevFlow[i-1] << ")";
+                if(citiesPrevFlow[i] != flow) {
+                    line << " (Previous flow : " << citiesPrevFlow[i] << ")";
                     ColorPrint("pink", line.str());
                     file << line.str();
                 }
@@ -1182,71 +1516,101 @@ void Menu::printAffectedCity(const string& city, double flow, double demand,
     ColorPrint("cyan", "(" + convertDouble(flow, 0) + "/" + convertDouble(demand, 0) + ")");
 }
 
-void Menu::removeReservoirsScratch(vector<double> citiesPrevFlow) {
+void Menu::removeReservoirsScratch(const vector<double>& citiesPrevFlow, const vector<double>& baseline) {
     ColorPrint("cyan", "\nReservoir: Altered City [Flow Difference](Flow / Demand) | ...\n\n");
-    for (int i = 1; i <= waterSupply.getReservoirs().size(); i++) {
-        string name = "R_" + to_string(i);
-        if(!waterSupply.getNetwork()->findVertex(name)->checkActive()) continue;
-        maxFlow.deleteReservoirScratch(name, waterSupply.getNetwork());
+    const vector<unsigned>& cityIds = waterSupply.getCityIds();
+    unsigned total = 0, skipped = 0;
+    for (unsigned id: waterSupply.getReservoirIds()) {
+        const string& name = waterSupply.getNetwork()->getInfo(id);
+        if(!waterSupply.getNetwork()->findVertex(id)->checkActive()) continue;
         int count = 0;
         ostringstream tmp;
         tmp << left << setw(6) << name + ": ";
         ColorPrint("blue", tmp.str());
-        for(int j = 1; j <= waterSupply.getCities().size(); j++) {
-            auto city = waterSupply.getCity("C_" + to_string(j));
-            double flow = waterSupply.computeCityFlow(city.getCode());
-            if (flow != citiesPrevFlow[j-1]) {
-                printAffectedCity("C_" + to_string(j), flow, city.getDemand(), flow - citiesPrevFlow[j-1], count);
+        total++;
+        if (maxFlow.isRemovalNeutral(waterSupply.getNetwork(), waterSupply.getWorkspace(), baseline, waterSupply.getNetwork()->findVertex(id))) {
+            skipped++;
+            ColorPrint("pink", "(No changes of flow to any City)");
+            ColorPrint("white", "\n\n");
+            continue;
+        }
+        maxFlow.deleteReservoirScratch(id, waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
+        for(unsigned j = 0; j < cityIds.size(); j++) {
+            const City& city = waterSupply.getCity(cityIds[j]);
+            double flow = waterSupply.computeCityFlow(cityIds[j]);
+            if (flow != citiesPrevFlow[j]) {
+                printAffectedCity(city.getCode(), flow, city.getDemand(), flow - citiesPrevFlow[j], count);
                 count++;
             }
         }
         if(!count) ColorPrint("pink", "(No changes of flow to any City)");
         ColorPrint("white", "\n\n");
-        waterSupply.getNetwork()->findVertex(name)->activate();
+        waterSupply.getNetwork()->findVertex(id)->activate();
     }
+    printSkippedSolves(skipped, total);
 }
 
-void Menu::removeStationsScratch(vector<double> citiesPrevFlow) {
+void Menu::removeStationsScratch(const vector<double>& citiesPrevFlow, const vector<double>& baseline) {
     ColorPrint("cyan", "\nStation: Altered City [Flow Difference](Flow / Demand) | ...\n\n");
-    for (int i = 1; i <= waterSupply.getStations().size(); i++) {
-        string name = "PS_" + to_string(i);
-        if(!waterSupply.getNetwork()->findVertex(name)->checkActive()) continue;
+    const vector<unsigned>& cityIds = waterSupply.getCityIds();
+    unsigned total = 0, skipped = 0;
+    for (unsigned id: waterSupply.getStationIds()) {
+        const string& name = waterSupply.getNetwork()->getInfo(id);
+        if(!waterSupply.getNetwork()->findVertex(id)->checkActive()) continue;
         int count = 0;
         ostringstream tmp;
         tmp << left << setw(6) << name + ": ";
         ColorPrint("blue", tmp.str());
-        maxFlow.deleteStationScratch(name, waterSupply.getNetwork());
-        for(int j = 1; j <= waterSupply.getCities().size(); j++) {
-            auto city = waterSupply.getCity("C_" + to_string(j));
-            double flow = waterSupply.computeCityFlow(city.getCode());
-            if (flow != citiesPrevFlow[j-1]) {
-                printAffectedCity("C_" + to_string(j), flow, city.getDemand(), flow - citiesPrevFlow[j-1], count);
+        total++;
+        if (maxFlow.isRemovalNeutral(waterSupply.getNetwork(), waterSupply.getWorkspace(), baseline, waterSupply.getNetwork()->findVertex(id))) {
+            skipped++;
+            ColorPrint("pink", "(No changes of flow to any City)");
+            ColorPrint("white", "\n\n");
+            continue;
+        }
+        maxFlow.deleteStationScratch(id, waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
+        for(unsigned j = 0; j < cityIds.size(); j++) {
+            const City& city = waterSupply.getCity(cityIds[j]);
+            double flow = waterSupply.computeCityFlow(cityIds[j]);
+            if (flow != citiesPrevFlow[j]) {
+                printAffectedCity(city.getCode(), flow, city.getDemand(), flow - citiesPrevFlow[j], count);
                 count++;
             }
         }
         if(!count) ColorPrint("pink", "(No changes of flow to any City)");
         ColorPrint("white", "\n\n");
-        waterSupply.getNetwork()->findVertex(name)->activate();
+        waterSupply.getNetwork()->findVertex(id)->activate();
     }
+    printSkippedSolves(skipped, total);
 }
 
-void Menu::removePipesScratch(vector<double> citiesPrevFlow) {
+void Menu::removePipesScratch(const vector<double>& citiesPrevFlow, const vector<double>& baseline) {
     ColorPrint("cyan", "\nPipe origin - Pipe destination: Altered City [Flow Difference](Flow / Demand) | ...\n\n");
-    for (const auto& v : waterSupply.getNetwork()->getVertexSet()) {
-        if (v.first.substr(0,1) == "C" || v.first == "src") continue;
-        for (auto e: v.second->getAdj()) {
+    const vector<unsigned>& cityIds = waterSupply.getCityIds();
+    unsigned total = 0, skipped = 0;
+    unsigned src = waterSupply.getVertexId("src");
+    for (auto v : waterSupply.getNetwork()->getVertexSet()) {
+        if (v->getInfo().substr(0,1) == "C" || v->getId() == src) continue;
+        for (auto e: v->getAdj()) {
             if(!e->checkActive()) continue;
             if ((e->getReverse() != nullptr) && e->getOrig()->getInfo() < e->getDest()->getInfo()) continue;
             int count = 0;
             ostringstream tmp;
             tmp << left << setw(16) << e->getOrig()->getInfo() + " - " + e->getDest()->getInfo() + ": ";
             ColorPrint("blue", tmp.str());
-            maxFlow.deletePipeScratch(e->getOrig()->getInfo(), e->getDest()->getInfo(), waterSupply.getNetwork());
-            for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-                auto city = waterSupply.getCity("C_" + to_string(i));
-                double flow = waterSupply.computeCityFlow(city.getCode());
-                if (flow != citiesPrevFlow[i-1]) {
-                    printAffectedCity("C_" + to_string(i), flow, city.getDemand(), flow - citiesPrevFlow[i-1], count);
+            total++;
+            if (maxFlow.isRemovalNeutral(waterSupply.getNetwork(), waterSupply.getWorkspace(), baseline, e)) {
+                skipped++;
+                ColorPrint("pink", "(No changes of flow to any City)");
+                ColorPrint("white", "\n\n");
+                continue;
+            }
+            maxFlow.deletePipeScratch(e->getOrig()->getId(), e->getDest()->getId(), waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
+            for(unsigned i = 0; i < cityIds.size(); i++) {
+                const City& city = waterSupply.getCity(cityIds[i]);
+                double flow = waterSupply.computeCityFlow(cityIds[i]);
+                if (flow != citiesPrevFlow[i]) {
+                    printAffectedCity(city.getCode(), flow, city.getDemand(), flow - citiesPrevFlow[i], count);
                     count++;
                 }
             }
@@ -1258,77 +1622,80 @@ void Menu::removePipesScratch(vector<double> citiesPrevFlow) {
             }
         }
     }
+    printSkippedSolves(skipped, total);
 }
 
-void Menu::removeReservoirs(std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge*>>>> paths, string network, vector<double> citiesPrevFlow) {
+void Menu::removeReservoirs(const std::string& network, const vector<double>& citiesPrevFlow) {
     ColorPrint("cyan", "\nReservoir: Altered City [Flow Difference](Flow / Demand) | ...\n\n");
-    for (int i = 1; i <= waterSupply.getReservoirs().size(); i++) {
-        string name = "R_" + to_string(i);
-        if(!waterSupply.getNetwork()->findVertex(name)->checkActive()) continue;
-        maxFlow.deleteReservoir(name, waterSupply.getNetwork());
+    const vector<unsigned>& cityIds = waterSupply.getCityIds();
+    for (unsigned id: waterSupply.getReservoirIds()) {
+        const string& name = waterSupply.getNetwork()->getInfo(id);
+        if(!waterSupply.getNetwork()->findVertex(id)->checkActive()) continue;
+        maxFlow.deleteReservoir(id, waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
         int count = 0;
         ostringstream tmp;
         tmp << left << setw(6) << name + ": ";
         ColorPrint("blue", tmp.str());
-        for(int j = 1; j <= waterSupply.getCities().size(); j++) {
-            auto city = waterSupply.getCity("C_" + to_string(j));
-            double flow = waterSupply.computeCityFlow(city.getCode());
-            if (flow != citiesPrevFlow[j-1]) {
-                printAffectedCity("C_" + to_string(j), flow, city.getDemand(), flow - citiesPrevFlow[j-1], count);
+        for(unsigned j = 0; j < cityIds.size(); j++) {
+            const City& city = waterSupply.getCity(cityIds[j]);
+            double flow = waterSupply.computeCityFlow(cityIds[j]);
+            if (flow != citiesPrevFlow[j]) {
+                printAffectedCity(city.getCode(), flow, city.getDemand(), flow - citiesPrevFlow[j], count);
                 count++;
             }
         }
         if(!count) ColorPrint("pink", "(No changes of flow to any City)");
         ColorPrint("white", "\n\n");
-        waterSupply.getNetwork()->findVertex(name)->activate();
+        waterSupply.getNetwork()->findVertex(id)->activate();
         waterSupply.readNetwork(network);
-        maxFlow.setPaths(paths, waterSupply.getNetwork());
     }
 }
 
-void Menu::removeStations(std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge*>>>> paths, string network, vector<double> citiesPrevFlow) {
+void Menu::removeStations(const std::string& network, const vector<double>& citiesPrevFlow) {
     ColorPrint("cyan", "\nStation: Altered City [Flow Difference](Flow / Demand) | ...\n\n");
-    for (int i = 1; i <= waterSupply.getStations().size(); i++) {
-        string name = "PS_" + to_string(i);
-        if(!waterSupply.getNetwork()->findVertex(name)->checkActive()) continue;
+    const vector<unsigned>& cityIds = waterSupply.getCityIds();
+    for (unsigned id: waterSupply.getStationIds()) {
+        const string& name = waterSupply.getNetwork()->getInfo(id);
+        if(!waterSupply.getNetwork()->findVertex(id)->checkActive()) continue;
         int count = 0;
         ostringstream tmp;
         tmp << left << setw(6) << name + ": ";
         ColorPrint("blue", tmp.str());
-        maxFlow.deleteStation(name, waterSupply.getNetwork());
-        for(int j = 1; j <= waterSupply.getCities().size(); j++) {
-            auto city = waterSupply.getCity("C_" + to_string(j));
-            double flow = waterSupply.computeCityFlow(city.getCode());
-            if (flow != citiesPrevFlow[j-1]) {
-                printAffectedCity("C_" + to_string(j), flow, city.getDemand(), flow - citiesPrevFlow[j-1], count);
+        maxFlow.deleteStation(id, waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
+        for(unsigned j = 0; j < cityIds.size(); j++) {
+            const City& city = waterSupply.getCity(cityIds[j]);
+            double flow = waterSupply.computeCityFlow(cityIds[j]);
+            if (flow != citiesPrevFlow[j]) {
+                printAffectedCity(city.getCode(), flow, city.getDemand(), flow - citiesPrevFlow[j], count);
                 count++;
             }
         }
         if(!count) ColorPrint("pink", "(No changes of flow to any City)");
         ColorPrint("white", "\n\n");
-        waterSupply.getNetwork()->findVertex(name)->activate();
+        waterSupply.getNetwork()->findVertex(id)->activate();
         waterSupply.readNetwork(network);
-        maxFlow.setPaths(paths, waterSupply.getNetwork());
     }
 }
 
-void Menu::removePipes(std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge*>>>> paths, string network, vector<double> citiesPrevFlow) {
+void Menu::removePipes(const std::string& network, const vector<double>& citiesPrevFlow) {
     ColorPrint("cyan", "\nPipe origin - Pipe destination: Altered City [Flow Difference](Flow / Demand) | ...\n\n");
-    for (const auto& v : waterSupply.getNetwork()->getVertexSet()) {
-        if (v.first.substr(0,1) == "C" || v.first == "src") continue;
-        for (auto e: v.second->getAdj()) {
+    const vector<unsigned>& cityIds = waterSupply.getCityIds();
+    unsigned src = waterSupply.getVertexId("src");
+    for (auto v : waterSupply.getNetwork()->getVertexSet()) {
+        if (v->getInfo().substr(0,1) == "C" || v->getId() == src) continue;
+        for (auto e: v->getAdj()) {
             if(!e->checkActive()) continue;
             if ((e->getReverse() != nullptr) && e->getOrig()->getInfo() < e->getDest()->getInfo()) continue;
             int count = 0;
             ostringstream tmp;
             tmp << left << setw(16) << e->getOrig()->getInfo() + " - " + e->getDest()->getInfo() + ": ";
             ColorPrint("blue", tmp.str());
-            maxFlow.deletePipe(e->getOrig()->getInfo(), e->getDest()->getInfo(), waterSupply.getNetwork());
-            for(int i = 1; i <= waterSupply.getCities().size(); i++) {
-                auto city = waterSupply.getCity("C_" + to_string(i));
-                double flow = waterSupply.computeCityFlow(city.getCode());
-                if (flow != citiesPrevFlow[i-1]) {
-                    printAffectedCity("C_" + to_string(i), flow, city.getDemand(), flow - citiesPrevFlow[i-1], count);
+            maxFlow.deletePipe(e->getOrig()->getId(), e->getDest()->getId(), waterSupply.getNetwork(), waterSupply.getWorkspace(), waterSupply.getEngine());
+            for(unsigned i = 0; i < cityIds.size(); i++) {
+                const City& city = waterSupply.getCity(cityIds[i]);
+                double flow = waterSupply.computeCityFlow(cityIds[i]);
+                if (flow != citiesPrevFlow[i]) {
+                    printAffectedCity(city.getCode(), flow, city.getDemand(), flow - citiesPrevFlow[i], count);
                     count++;
                 }
             }
@@ -1339,7 +1706,6 @@ void Menu::removePipes(std::unordered_map<unsigned int, std::pair<double, std::v
                 e->getReverse()->activate();
             }
             waterSupply.readNetwork(network);
-            maxFlow.setPaths(paths, waterSupply.getNetwork());
         }
     }
 }
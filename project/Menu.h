@@ -39,6 +39,7 @@
  */
 
 #include "WaterSupply.h"
+#include "Contingency.h"
 
 /**
  * \class Menu
@@ -84,6 +85,15 @@ public:
      * @return The option from user input.
      */
     static char readOption(int n);
+    /**
+     * \brief Reads a number between the given bounds from user input.
+     *
+     * @param min The smallest valid number.
+     * @param max The largest valid number.
+     * @param fallback The number returned if the input is empty.
+     * @return The number from user input.
+     */
+    static double readNumber(double min, double max, double fallback);
     /**
      * \brief Asks user for a valid City code.
      *
@@ -212,7 +222,18 @@ public:
      *
      * @param citiesPrevFlow The previous flow of all City (can be empty).
      */
-    void printCitiesFlow(std::vector<double> citiesPrevFlow = {});
+    void printCitiesFlow(const std::vector<double>& citiesPrevFlow = {});
+    /**
+     * \brief Outputs the pushes, relabels and time of each thread of the last parallel max flow.
+     */
+    void printThreadWork();
+    /**
+     * \brief Outputs how many removals of a reliability listing were skipped because they could not change any City.
+     *
+     * @param skipped The number of removals that were not solved.
+     * @param total The number of removals listed.
+     */
+    void printSkippedSolves(unsigned skipped, unsigned total);
     /**
      * \brief Calls the printCitiesFlow() and outputs the average, max and variance of (Capacity - Flow) of the Graph.
      */
@@ -231,10 +252,22 @@ public:
      * \brief Outputs the change display mode options and handles the respective inputs.
      */
     void changeDisplayMode();
+    /**
+     * \brief Outputs the max flow engine options and handles the respective inputs.
+     */
+    void changeMaxFlowEngine();
+    /**
+     * \brief Outputs the min-cost engine options and handles the respective inputs.
+     */
+    void changeMinCostEngine();
     /**
      * \brief Outputs the reliability options and handles the respective inputs.
      */
     void reliabilityMenu();
+    /**
+     * \brief Outputs the balance network load options and handles the respective inputs.
+     */
+    void balanceMenu();
     /**
      * \brief Outputs the check deactivated components options and handles the respective inputs.
      */
@@ -258,18 +291,15 @@ public:
      /**
      * \brief Outputs the result of removing the reservoirs of the network one by one without doing maxflow from scratch.
      */
-    void removeReservoirs(std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge *>>>> paths,
-                          std::string network, std::vector<double> citiesPrevFlow);
+    void removeReservoirs(const std::string& network, const std::vector<double>& citiesPrevFlow);
     /**
     * \brief Outputs the result of removing the stations of the network one by one without doing maxflow from scratch.
     */
-    void removeStations(std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge *>>>> paths,
-                        std::string network, std::vector<double> citiesPrevFlow);
+    void removeStations(const std::string& network, const std::vector<double>& citiesPrevFlow);
     /**
     * \brief Outputs the result of removing the pipes of the network one by one without doing maxflow from scratch.
     */
-    void removePipes(std::unordered_map<unsigned int, std::pair<double, std::vector<std::pair<bool, Edge *>>>> paths,
-                     std::string network, std::vector<double> citiesPrevFlow);
+    void removePipes(const std::string& network, const std::vector<double>& citiesPrevFlow);
     /**
      * \brief Outputs the list reliability testing options and handles the respective inputs.
      */
@@ -279,17 +309,51 @@ public:
      */
     void listReliabilityScratch();
      /**
-     * \brief Outputs the result of removing the reservoirs of the network one by one doing maxflow from scratch.
+     * \brief Outputs the result of removing the reservoirs of the network one by one doing maxflow from scratch, skipping the
+     * removals that cannot change the flow of any City.
      */
-    void removeReservoirsScratch(std::vector<double> citiesPrevFlow);
+    void removeReservoirsScratch(const std::vector<double>& citiesPrevFlow, const std::vector<double>& baseline);
      /**
-     * \brief Outputs the result of removing the stations of the network one by one doing maxflow from scratch.
+     * \brief Outputs the result of removing the stations of the network one by one doing maxflow from scratch, skipping the
+     * removals that cannot change the flow of any City.
      */
-    void removeStationsScratch(std::vector<double> citiesPrevFlow);
+    void removeStationsScratch(const std::vector<double>& citiesPrevFlow, const std::vector<double>& baseline);
       /**
-     * \brief Outputs the result of removing the pipes of the network one by one doing maxflow from scratch.
+     * \brief Outputs the result of removing the pipes of the network one by one doing maxflow from scratch, skipping the
+     * removals that cannot change the flow of any City.
+     */
+    void removePipesScratch(const std::vector<double>& citiesPrevFlow, const std::vector<double>& baseline);
+    /**
+     * \brief Outputs the list reliability testing options evaluated in parallel by Contingency and handles the
+     * respective inputs.
+     */
+    void listContingency();
+    /**
+     * \brief Reads the class of components and the largest number of them failing together, enumerates their
+     * combined outages with Contingency and outputs the counts of each size, writing the results to a file.
+     */
+    void listCombinedOutages();
+    /**
+     * \brief Reads the number of samples, the seed and the failure probability of the components without one, runs
+     * the Monte Carlo simulation of Contingency and outputs the expected unmet demand of each City.
+     */
+    void monteCarloSimulation();
+    /**
+     * \brief Builds the outages of the components selected by a menu option.
+     *
+     * @param contingency The Contingency that builds the outages.
+     * @param option '1' for the reservoirs, '2' for the stations, '3' for the pipes and '4' for all of them.
+     * @return The outages of the selected components.
+     */
+    static std::vector<Outage> contingencyComponents(Contingency& contingency, char option);
+    /**
+     * \brief Outputs the Cities affected by each outage and the water they lose, followed by a summary of the run.
+     *
+     * @param outages The outages that were evaluated.
+     * @param results The result of each outage.
+     * @param threads The number of threads used.
      */
-    void removePipesScratch(std::vector<double> citiesPrevFlow);
+    void printContingency(const std::vector<Outage>& outages, const std::vector<OutageResult>& results, unsigned threads);
 };
 
 
@@ -0,0 +1,481 @@
+#include "MinCostFlow.h"
+#include "datastructures/RadixHeap.h"
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+/********************** Successive shortest paths  ****************************/
+
+long long reducedCost(const SolverWorkspace& ws, unsigned a) {
+    const FlowGraph& g = ws.getGraph();
+    long long cost = g.isForward(a) ? ws.cost[g.edgeOf(a)] : -ws.cost[g.edgeOf(a)];
+    return cost + ws.potential[g.tail(a)] - ws.potential[g.head(a)];
+}
+
+bool findCheapestPath(SolverWorkspace& ws, unsigned src, unsigned snk) {
+    // Dijkstra that stops once the sink is settled; labeled vertices are in the queue or settled. The reduced costs
+    // are non-negative integers, so the distances fit the monotone integer keys of a radix heap
+    const FlowGraph& g = ws.getGraph();
+    RadixHeap<unsigned long long> q(ws.queueIndex);
+    std::fill(ws.visited.begin(), ws.visited.end(), false);
+    ws.newSearch();
+    ws.label(src);
+    ws.dist[src] = 0;
+    q.insert(src, 0);
+    while (!q.empty()) {
+        unsigned u = q.extractMin();
+        ws.visited[u] = true;
+        if (u == snk) break;
+        for (unsigned a = g.arcBegin(u); a < g.arcEnd(u); a++) {
+            unsigned v = g.head(a);
+            if (ws.visited[v] || ws.residual(a) <= 0 || !ws.isUsable(a)) continue;
+            double d = ws.dist[u] + (double) reducedCost(ws, a);
+            if (!ws.isLabeled(v)) {
+                ws.label(v);
+                ws.dist[v] = d;
+                ws.path[v] = a;
+                q.insert(v, (unsigned long long) d);
+            } else if (d < ws.dist[v]) {
+                ws.dist[v] = d;
+                ws.path[v] = a;
+                q.decreaseKey(v, (unsigned long long) d);
+            }
+        }
+    }
+    if (!ws.visited[snk]) return false;
+    // vertices settled before the sink keep their distance, the others are at least as far as the sink
+    auto reach = (long long) ws.dist[snk];
+    for (unsigned v = 0; v < g.getNumVertex(); v++) {
+        ws.potential[v] += ws.visited[v] ? (long long) ws.dist[v] : reach;
+    }
+    return true;
+}
+
+double MinCostFlow::minCostMaxFlow(unsigned src, unsigned snk, SolverWorkspace& ws) {
+    const FlowGraph& g = ws.getGraph();
+    std::fill(ws.flow.begin(), ws.flow.end(), 0);
+    std::fill(ws.potential.begin(), ws.potential.end(), 0);  // valid for the zero flow since no cost is negative
+    while (findCheapestPath(ws, src, snk)) {
+        double cf = INF;
+        for (unsigned v = snk; v != src; v = g.tail(ws.path[v])) cf = std::min(cf, ws.residual(ws.path[v]));
+        for (unsigned v = snk; v != src; v = g.tail(ws.path[v])) ws.push(ws.path[v], cf);
+    }
+    double total = 0;
+    for (unsigned e = 0; e < g.getNumEdge(); e++) total += (double) ws.cost[e] * ws.flow[e];
+    return total;
+}
+
+/********************** Convex cost scaling  ****************************/
+
+/**
+ * \brief The residual network of a convex cost flow, in which every Edge is split into parallel segments of
+ * increasing cost. Arcs come in pairs: 2i is a segment and 2i + 1 its reverse.
+ */
+struct SegmentNetwork {
+    std::vector<unsigned> arcHead;
+    std::vector<double> residual;
+    std::vector<long long> cost;
+    std::vector<unsigned> offset;    // arcs leaving vertex v are arcs[offset[v]..offset[v+1])
+    std::vector<unsigned> arcs;
+    std::vector<unsigned> firstArc;  // first segment of each Edge, the segments of Edge e end where those of e+1 begin
+
+    long long reduced(unsigned a, const std::vector<long long>& price) const {
+        return cost[a] + price[arcHead[a ^ 1]] - price[arcHead[a]];
+    }
+    void push(unsigned a, double amount, std::vector<double>& excess) {
+        residual[a] -= amount;
+        residual[a ^ 1] += amount;
+        excess[arcHead[a ^ 1]] -= amount;
+        excess[arcHead[a]] += amount;
+    }
+};
+
+SegmentNetwork buildSegments(const SolverWorkspace& ws, const std::vector<double>& target,
+                             const std::vector<char>& oneSided, unsigned segments, long long scale, long long& maxCost) {
+    const FlowGraph& g = ws.getGraph();
+    SegmentNetwork net;
+    maxCost = 0;
+    for (unsigned e = 0; e < g.getNumEdge(); e++) {
+        auto penalty = [&](double f) { return oneSided[e] && f < target[e] ? 0.0 : (f - target[e]) * (f - target[e]); };
+        net.firstArc.push_back(net.arcHead.size());
+        bool usable = ws.edgeActive[e] && ws.vertexActive[g.getOrig(e)] && ws.vertexActive[g.getDest(e)];
+        double capacity = ws.capacity[e];
+        if (!usable || capacity <= 0) continue;
+        // a single segment for the edges without a quadratic penalty, equal integer widths for the others
+        unsigned k = target[e] >= INF || capacity >= INF ? 1 : (unsigned) std::min<double>(segments, capacity);
+        double flow = ws.flow[e];
+        for (unsigned s = 0; s < k; s++) {
+            double lo = k == 1 ? 0 : std::floor(capacity * s / k), hi = k == 1 ? capacity : std::floor(capacity * (s + 1) / k);
+            double slope = k == 1 ? 0 : (penalty(hi) - penalty(lo)) / (hi - lo);
+            long long c = (ws.cost[e] + llround(slope)) * scale;
+            double used = std::max(0.0, std::min(flow - lo, hi - lo));  // convex, so the flow fills the cheapest first
+            net.arcHead.push_back(g.getDest(e));
+            net.residual.push_back(hi - lo - used);
+            net.cost.push_back(c);
+            net.arcHead.push_back(g.getOrig(e));
+            net.residual.push_back(used);
+            net.cost.push_back(-c);
+            maxCost = std::max(maxCost, std::abs(c));
+        }
+    }
+    net.firstArc.push_back(net.arcHead.size());
+    unsigned numVertex = g.getNumVertex();
+    net.offset.assign(numVertex + 1, 0);
+    for (unsigned a = 0; a < net.arcHead.size(); a++) net.offset[net.arcHead[a ^ 1] + 1]++;
+    for (unsigned v = 0; v < numVertex; v++) net.offset[v + 1] += net.offset[v];
+    net.arcs.resize(net.arcHead.size());
+    std::vector<unsigned> fill(net.offset.begin(), net.offset.end() - 1);
+    for (unsigned a = 0; a < net.arcHead.size(); a++) net.arcs[fill[net.arcHead[a ^ 1]]++] = a;
+    return net;
+}
+
+void refine(SegmentNetwork& net, SolverWorkspace& ws, long long eps, CostScalingStats& stats) {
+    unsigned numVertex = net.offset.size() - 1;
+    std::vector<long long>& price = ws.potential;
+    std::vector<double>& excess = ws.excess;
+    std::fill(excess.begin(), excess.end(), 0);
+    for (unsigned a = 0; a < net.arcHead.size(); a++) {
+        if (net.residual[a] > 0 && net.reduced(a, price) < 0) net.push(a, net.residual[a], excess);
+    }
+    unsigned* ring = ws.active.data();  // FIFO of the vertices with excess, each at most once
+    unsigned head = 0, size = 0;
+    for (unsigned v = 0; v < numVertex; v++) {
+        ws.currentArc[v] = net.offset[v];
+        ws.visited[v] = excess[v] > 0;
+        if (excess[v] > 0) ring[(head + size++) % numVertex] = v;
+    }
+    while (size > 0) {
+        unsigned v = ring[head];
+        head = (head + 1) % numVertex;
+        size--;
+        ws.visited[v] = false;
+        while (excess[v] > 0) {
+            if (ws.currentArc[v] == net.offset[v + 1]) {
+                // relabel: the cheapest residual arc of v becomes admissible by eps
+                long long best = std::numeric_limits<long long>::min();
+                for (unsigned i = net.offset[v]; i < net.offset[v + 1]; i++) {
+                    unsigned a = net.arcs[i];
+                    if (net.residual[a] > 0) best = std::max(best, price[net.arcHead[a]] - net.cost[a]);
+                }
+                if (best == std::numeric_limits<long long>::min()) return;  // no way out, the balances are infeasible
+                price[v] = best - eps;
+                ws.currentArc[v] = net.offset[v];
+                stats.relabels++;
+                continue;
+            }
+            unsigned a = net.arcs[ws.currentArc[v]];
+            if (net.residual[a] > 0 && net.reduced(a, price) < 0) {
+                unsigned w = net.arcHead[a];
+                net.push(a, std::min(excess[v], net.residual[a]), excess);
+                stats.pushes++;
+                if (excess[w] > 0 && !ws.visited[w]) {
+                    ws.visited[w] = true;
+                    ring[(head + size++) % numVertex] = w;
+                }
+            } else {
+                ws.currentArc[v]++;
+            }
+        }
+    }
+}
+
+CostScalingStats MinCostFlow::minConvexCostFlow(SolverWorkspace& ws, const std::vector<double>& target,
+                                                const std::vector<char>& oneSided, unsigned segments) {
+    static constexpr long long ALPHA = 8;  // factor by which eps shrinks in each phase
+    const FlowGraph& g = ws.getGraph();
+    // with every cost multiplied by V + 1, a flow that is 1-optimal for the scaled costs is optimal
+    long long scale = g.getNumVertex() + 1, eps;
+    SegmentNetwork net = buildSegments(ws, target, oneSided, segments, scale, eps);
+    CostScalingStats stats;
+    std::fill(ws.potential.begin(), ws.potential.end(), 0);
+    while (eps > 1) {
+        eps = std::max(1ll, eps / ALPHA);
+        refine(net, ws, eps, stats);
+        stats.phases++;
+    }
+    for (unsigned e = 0; e < g.getNumEdge(); e++) {
+        if (net.firstArc[e] == net.firstArc[e + 1]) continue;
+        ws.flow[e] = 0;
+        for (unsigned a = net.firstArc[e]; a < net.firstArc[e + 1]; a += 2) ws.flow[e] += net.residual[a + 1];
+    }
+    for (unsigned a = 0; a < net.arcHead.size(); a += 2) stats.cost += (double) net.cost[a] / scale * net.residual[a + 1];
+    return stats;
+}
+
+/********************** Network simplex  ****************************/
+
+enum : signed char { STATE_UPPER = -1, STATE_TREE = 0, STATE_LOWER = 1 };
+enum : signed char { DIR_DOWN = -1, DIR_UP = 1 };
+
+/**
+ * \brief The arcs and the spanning tree basis of a network simplex run. Arcs [0, E) are the Edge, arc E goes back
+ * from the sink to the source and arc E + 1 + v is the artificial arc between vertex v and the root, the last node.
+ */
+struct SimplexNetwork {
+    static constexpr unsigned NONE = SolverWorkspace::NONE;
+    unsigned root;
+    std::vector<unsigned> source, target;
+    std::vector<double> capacity, flow;
+    std::vector<long long> cost;
+    std::vector<signed char>& state;
+    std::vector<unsigned> parent, pred, depth, firstChild, nextSibling, prevSibling;
+    std::vector<signed char> dir;     // DIR_UP if the arc to the parent leaves the node
+    std::vector<long long> pi;        // every tree arc has reduced cost 0
+
+    SimplexNetwork(unsigned numNode, unsigned numArc, std::vector<signed char>& state)
+            : root(numNode - 1), source(numArc), target(numArc), capacity(numArc), flow(numArc), cost(numArc),
+              state(state), parent(numNode, NONE), pred(numNode, NONE), depth(numNode), firstChild(numNode, NONE),
+              nextSibling(numNode, NONE), prevSibling(numNode, NONE), dir(numNode), pi(numNode) {}
+
+    long long reduced(unsigned a) const { return cost[a] + pi[source[a]] - pi[target[a]]; }
+    unsigned artificial(unsigned v) const { return source.size() - root + v; }
+    void detach(unsigned v) {
+        if (prevSibling[v] != NONE) nextSibling[prevSibling[v]] = nextSibling[v];
+        else firstChild[parent[v]] = nextSibling[v];
+        if (nextSibling[v] != NONE) prevSibling[nextSibling[v]] = prevSibling[v];
+    }
+    void attach(unsigned v, unsigned p) {
+        parent[v] = p;
+        prevSibling[v] = NONE;
+        nextSibling[v] = firstChild[p];
+        if (firstChild[p] != NONE) prevSibling[firstChild[p]] = v;
+        firstChild[p] = v;
+    }
+    // hangs v from the root through its artificial arc, which carries the excess of v in either direction
+    void hangFromRoot(unsigned v, double excess) {
+        unsigned a = artificial(v);
+        source[a] = excess >= 0 ? v : root;
+        target[a] = excess >= 0 ? root : v;
+        flow[a] = std::abs(excess);
+        state[a] = STATE_TREE;
+        parent[v] = root;
+        pred[v] = a;
+        dir[v] = excess >= 0 ? DIR_UP : DIR_DOWN;
+    }
+};
+
+/**
+ * \brief Turns the arc states into a strongly feasible spanning tree: the non-tree arcs sit at their bounds and the
+ * tree arcs carry the rest, with positive residual capacity on the way to the root. A tree arc that cannot is moved
+ * to its nearest bound and its subtree is hung from the root, so a basis left by an earlier run survives a change of
+ * capacities.
+ */
+void buildTree(SimplexNetwork& net) {
+    unsigned numNode = net.root + 1, numArc = net.source.size();
+    std::vector<std::vector<unsigned>> treeArcs(numNode);
+    std::vector<double> excess(numNode, 0);
+    for (unsigned a = 0; a < numArc; a++) {
+        if (net.state[a] == STATE_UPPER && net.capacity[a] >= INF) net.state[a] = STATE_LOWER;
+        net.flow[a] = net.state[a] == STATE_UPPER ? net.capacity[a] : 0;
+        if (net.state[a] == STATE_TREE) {
+            treeArcs[net.source[a]].push_back(a);
+            treeArcs[net.target[a]].push_back(a);
+        }
+    }
+    // the tree arcs reached first from the root form the tree, any other becomes non-tree
+    std::vector<unsigned> order{net.root};
+    std::vector<char> used(numArc, false);
+    net.parent[net.root] = SolverWorkspace::NONE;
+    for (unsigned i = 0; i < order.size(); i++) {
+        unsigned u = order[i];
+        for (unsigned a : treeArcs[u]) {
+            unsigned v = net.source[a] == u ? net.target[a] : net.source[a];
+            if (used[a] || v == net.root || net.parent[v] != SolverWorkspace::NONE) continue;
+            used[a] = true;
+            net.parent[v] = u;
+            net.pred[v] = a;
+            net.dir[v] = net.source[a] == v ? DIR_UP : DIR_DOWN;
+            order.push_back(v);
+        }
+    }
+    for (unsigned a = 0; a < numArc; a++) {
+        if (net.state[a] == STATE_TREE && !used[a]) net.state[a] = STATE_LOWER;
+        if (net.state[a] != STATE_TREE) {
+            excess[net.source[a]] -= net.flow[a];
+            excess[net.target[a]] += net.flow[a];
+        }
+    }
+    for (unsigned v = 0; v < net.root; v++) {
+        if (net.parent[v] == SolverWorkspace::NONE) {
+            net.hangFromRoot(v, 0);
+            order.push_back(v);
+        }
+    }
+    // from the leaves up, the arc to the parent carries the excess of the subtree
+    for (unsigned i = order.size() - 1; i > 0; i--) {
+        unsigned v = order[i], a = net.pred[v];
+        if (a >= net.artificial(0)) {
+            net.hangFromRoot(v, excess[v]);
+        } else {
+            double f = net.dir[v] == DIR_UP ? excess[v] : -excess[v];
+            bool feasible = net.dir[v] == DIR_UP ? f >= 0 && f < net.capacity[a] : f > 0 && f <= net.capacity[a];
+            if (!feasible) {
+                f = std::max(0.0, std::min(f, net.capacity[a]));
+                net.state[a] = f > 0 && f == net.capacity[a] ? STATE_UPPER : STATE_LOWER;
+                net.flow[a] = f;
+                double moved = net.dir[v] == DIR_UP ? f : -f;
+                excess[v] -= moved;
+                excess[net.parent[v]] += moved;
+                net.hangFromRoot(v, excess[v]);
+            } else {
+                net.flow[a] = f;
+            }
+        }
+        excess[net.parent[v]] += excess[v];
+    }
+    for (unsigned v = 0; v < net.root; v++) {
+        unsigned a = net.artificial(v);
+        if (net.state[a] != STATE_TREE) {
+            net.state[a] = STATE_LOWER;
+            net.flow[a] = 0;
+        }
+    }
+    // the order still lists every parent before its children
+    net.pi[net.root] = 0;
+    net.depth[net.root] = 0;
+    for (unsigned i = 1; i < order.size(); i++) {
+        unsigned v = order[i], a = net.pred[v];
+        net.attach(v, net.parent[v]);
+        net.pi[v] = net.dir[v] == DIR_UP ? net.pi[net.parent[v]] - net.cost[a] : net.pi[net.parent[v]] + net.cost[a];
+        net.depth[v] = net.depth[net.parent[v]] + 1;
+    }
+}
+
+/**
+ * \brief Block search pricing: scans the arcs in blocks of about √A from where the last search stopped and returns
+ * the most violating arc of the first block that has one, NONE if the basis is optimal.
+ */
+unsigned findEnteringArc(const SimplexNetwork& net, unsigned blockSize, unsigned& next) {
+    unsigned numArc = net.source.size(), best = SimplexNetwork::NONE, count = blockSize;
+    long long min = 0;
+    for (unsigned i = 0; i < numArc; i++) {
+        unsigned a = (next + i) % numArc;
+        long long c = net.state[a] * net.reduced(a);
+        if (c < min) {
+            min = c;
+            best = a;
+        }
+        if (--count == 0) {
+            if (best != SimplexNetwork::NONE) {
+                next = (a + 1) % numArc;
+                return best;
+            }
+            count = blockSize;
+        }
+    }
+    return best;
+}
+
+/**
+ * \brief Sends flow around the cycle the entering arc closes in the tree and swaps it with the leaving arc, chosen as
+ * the last blocking arc of the cycle so the tree stays strongly feasible.
+ */
+void pivot(SimplexNetwork& net, unsigned in, SimplexStats& stats, std::vector<unsigned>& stack) {
+    unsigned first = net.source[in], second = net.target[in];
+    if (net.state[in] == STATE_UPPER) std::swap(first, second);
+    unsigned u = first, v = second;
+    while (u != v) {
+        if (net.depth[u] > net.depth[v]) u = net.parent[u];
+        else if (net.depth[v] > net.depth[u]) v = net.parent[v];
+        else u = net.parent[u], v = net.parent[v];
+    }
+    unsigned join = u, out = SimplexNetwork::NONE;
+    double delta = net.capacity[in];
+    int side = 0;
+    for (u = first; u != join; u = net.parent[u]) {
+        unsigned a = net.pred[u];
+        double d = net.dir[u] == DIR_UP ? net.flow[a] : net.capacity[a] - net.flow[a];
+        if (d < delta) delta = d, out = u, side = 1;
+    }
+    for (u = second; u != join; u = net.parent[u]) {
+        unsigned a = net.pred[u];
+        double d = net.dir[u] == DIR_UP ? net.capacity[a] - net.flow[a] : net.flow[a];
+        if (d <= delta) delta = d, out = u, side = 2;
+    }
+    stats.pivots++;
+    if (delta > 0) {
+        double val = net.state[in] * delta;
+        net.flow[in] += val;
+        for (u = net.source[in]; u != join; u = net.parent[u]) net.flow[net.pred[u]] -= net.dir[u] * val;
+        for (u = net.target[in]; u != join; u = net.parent[u]) net.flow[net.pred[u]] += net.dir[u] * val;
+    } else {
+        stats.degenerate++;
+    }
+    if (side == 0) {
+        net.state[in] = -net.state[in];
+        return;
+    }
+    unsigned uIn = side == 1 ? first : second, vIn = side == 1 ? second : first;
+    unsigned leaving = net.pred[out];
+    net.state[leaving] = net.flow[leaving] == 0 ? STATE_LOWER : STATE_UPPER;
+    net.state[in] = STATE_TREE;
+    // the path from uIn up to out is reversed, then the whole subtree of uIn shifts its potentials and depths
+    unsigned newParent = vIn, newPred = in;
+    signed char newDir = net.source[in] == uIn ? DIR_UP : DIR_DOWN;
+    for (u = uIn;;) {
+        unsigned oldParent = net.parent[u], oldPred = net.pred[u];
+        signed char oldDir = net.dir[u];
+        net.detach(u);
+        net.attach(u, newParent);
+        net.pred[u] = newPred;
+        net.dir[u] = newDir;
+        if (u == out) break;
+        newParent = u, newPred = oldPred, newDir = -oldDir, u = oldParent;
+    }
+    long long sigma = (net.dir[uIn] == DIR_UP ? net.pi[vIn] - net.cost[in] : net.pi[vIn] + net.cost[in]) - net.pi[uIn];
+    stack.assign(1, uIn);
+    while (!stack.empty()) {
+        u = stack.back();
+        stack.pop_back();
+        net.pi[u] += sigma;
+        net.depth[u] = net.depth[net.parent[u]] + 1;
+        for (v = net.firstChild[u]; v != SimplexNetwork::NONE; v = net.nextSibling[v]) stack.push_back(v);
+    }
+}
+
+SimplexStats MinCostFlow::networkSimplex(unsigned source, unsigned sink, SolverWorkspace& ws) {
+    const FlowGraph& g = ws.getGraph();
+    unsigned numVertex = g.getNumVertex(), numEdge = g.getNumEdge(), numArc = numEdge + 1 + numVertex;
+    SimplexStats stats;
+    stats.warmStart = ws.basisValid && ws.basis.size() == numArc;
+    if (!stats.warmStart) {
+        ws.basis.assign(numArc, STATE_LOWER);
+        std::fill(ws.basis.begin() + numEdge + 1, ws.basis.end(), STATE_TREE);
+    }
+    SimplexNetwork net(numVertex + 1, numArc, ws.basis);
+    long long maxCost = 0;
+    double sourceCapacity = 0;
+    for (unsigned e = 0; e < numEdge; e++) {
+        net.source[e] = g.getOrig(e);
+        net.target[e] = g.getDest(e);
+        bool usable = ws.edgeActive[e] && ws.vertexActive[net.source[e]] && ws.vertexActive[net.target[e]];
+        net.capacity[e] = usable ? ws.capacity[e] : 0;
+        net.cost[e] = ws.cost[e];
+        maxCost = std::max(maxCost, std::abs(ws.cost[e]));
+        if (net.source[e] == source) sourceCapacity = std::min(INF, sourceCapacity + net.capacity[e]);
+    }
+    // the way back from the sink is cheaper than any path is expensive, so the cheapest circulation is a max flow
+    net.source[numEdge] = sink;
+    net.target[numEdge] = source;
+    net.capacity[numEdge] = sourceCapacity;
+    net.cost[numEdge] = -(long long) numVertex * maxCost - 1;
+    long long artificialCost = ((long long) numVertex * maxCost + 2) * (numVertex + 1);
+    for (unsigned v = 0; v < numVertex; v++) {
+        unsigned a = net.artificial(v);
+        net.source[a] = v;
+        net.target[a] = net.root;
+        net.capacity[a] = INF;
+        net.cost[a] = artificialCost;
+    }
+    buildTree(net);
+    unsigned blockSize = std::max(10u, (unsigned) std::sqrt((double) numArc)), next = 0, in;
+    std::vector<unsigned> stack;
+    while ((in = findEnteringArc(net, blockSize, next)) != SimplexNetwork::NONE) pivot(net, in, stats, stack);
+    for (unsigned e = 0; e < numEdge; e++) {
+        ws.flow[e] = net.flow[e];
+        stats.cost += (double) net.cost[e] * net.flow[e];
+    }
+    ws.basisValid = true;
+    return stats;
+}
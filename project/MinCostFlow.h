@@ -0,0 +1,102 @@
+#ifndef WATERSUPPLYMANAGER_MINCOSTFLOW_H
+#define WATERSUPPLYMANAGER_MINCOSTFLOW_H
+
+#include "datastructures/FlowGraph.h"
+#include "datastructures/SolverWorkspace.h"
+
+/**
+ * \brief The work done by MinCostFlow::minConvexCostFlow().
+ */
+struct CostScalingStats {
+    unsigned phases = 0;          // refinements, each dividing eps by the scaling factor
+    unsigned long pushes = 0;
+    unsigned long relabels = 0;
+    double cost = 0;              // cost of the flow under the piecewise-linear approximation
+};
+
+/**
+ * \brief The work done by MinCostFlow::networkSimplex().
+ */
+struct SimplexStats {
+    bool warmStart = false;       // true if the run started from the basis left by the previous one
+    unsigned long pivots = 0;
+    unsigned long degenerate = 0; // pivots that changed the basis without sending any flow
+    double cost = 0;              // total cost of the flow
+};
+
+/**
+ * \brief The algorithms that can compute a min-cost max flow.
+ */
+enum class MinCostEngine {
+    SUCCESSIVE_SHORTEST_PATHS, // Dijkstra with Johnson potentials, one augmenting path at a time from the zero flow
+    NETWORK_SIMPLEX            // spanning tree basis with block pivoting, warm started from the previous basis
+};
+
+/**
+ * \class MinCostFlow
+ * \brief A custom class containing the minimum cost flow algorithms.
+ *
+ * The algorithms run on a workspace that is already attached and loaded, whose cost array holds the integer cost of
+ * one unit of flow through each Edge.
+ */
+class MinCostFlow {
+public:
+    /**
+     * \brief Computes a maximum flow of minimum cost from source to sink with successive shortest paths.
+     *
+     * Starting from the zero flow, every augmentation follows a cheapest path of the residual network, found by
+     * Dijkstra over the costs reduced by Johnson potentials. The potentials are updated after each search, so the
+     * reduced costs stay non-negative and Bellman-Ford is never needed. The costs must be non-negative.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace, attached and loaded, with the cost of every Edge.
+     * @return The total cost of the flow.
+     *
+     *\par Complexity
+     * O(P (E + V) log V) in which P is the number of augmenting paths, V the number of vertex and E the number of
+     * edges of the Graph.
+     */
+    static double minCostMaxFlow(unsigned source, unsigned sink, SolverWorkspace& ws);
+    /**
+     * \brief Reroutes the flow held by the workspace to minimize a convex separable cost, keeping the net flow of every
+     * vertex.
+     *
+     * One unit of flow through Edge e costs ws.cost[e] plus the slope of (f - target[e])², or of max(0, f - target[e])²
+     * if the Edge is one-sided, approximated by splitting the Edge into parallel segments of equal integer width and
+     * increasing cost, rounded to integers. Segments below the target may cost less than nothing, so the flow can also
+     * change around cycles. The approximation is solved by cost scaling: each phase divides eps by 8 and refines the
+     * flow with push-relabel until it is eps-optimal, from the largest cost down to the optimum.
+     *
+     * @param ws The workspace, attached and loaded, holding a feasible flow and the linear cost of every Edge.
+     * @param target The flow each Edge is pulled towards, INF for no penalty.
+     * @param oneSided True for the Edge only penalized above their target.
+     * @param segments The number of segments of each penalized Edge, fewer if its capacity is smaller.
+     * @return The number of phases, pushes and relabels, and the cost reached.
+     *
+     *\par Complexity
+     * O(V² A log(VC)) in which V is the number of vertex, A the number of segments and C the largest segment cost.
+     */
+    static CostScalingStats minConvexCostFlow(SolverWorkspace& ws, const std::vector<double>& target,
+                                              const std::vector<char>& oneSided, unsigned segments);
+    /**
+     * \brief Computes a maximum flow of minimum cost from source to sink with the primal network simplex.
+     *
+     * An arc back from the sink to the source, cheaper than any path is expensive, turns the problem into a min-cost
+     * circulation. The basis is a spanning tree over the vertices and an artificial root: entering arcs are priced
+     * by block search, leaving arcs are chosen so the tree stays strongly feasible and degenerate pivots cannot cycle.
+     * The final basis is kept in the workspace, so the next run on the same FlowGraph, after a change of capacities
+     * or costs, starts from it instead of from the all artificial tree, and usually needs only a few pivots.
+     *
+     * @param source The source vertex ID.
+     * @param sink The sink vertex ID.
+     * @param ws The workspace, attached and loaded, with the cost of every Edge.
+     * @return The total cost of the flow and the pivots made.
+     *
+     *\par Complexity
+     * O(P (√E + V)) in which P is the number of pivots, V the number of vertex and E the number of edges of the Graph.
+     */
+    static SimplexStats networkSimplex(unsigned source, unsigned sink, SolverWorkspace& ws);
+};
+
+#endif //WATERSUPPLYMANAGER_MINCOSTFLOW_H
@@ -2,11 +2,11 @@
 #include "Reservoir.h"
 
 
-std::string Reservoir::getName() const {
+const std::string& Reservoir::getName() const {
     return name;
 }
 
-std::string Reservoir::getMunicipality() const {
+const std::string& Reservoir::getMunicipality() const {
     return municipality;
 }
 
@@ -14,11 +14,15 @@ int Reservoir::getDelivery() const {
     return maxDelivery;
 }
 
+double Reservoir::getFailureProbability() const {
+    return failureProbability;
+}
+
 int Reservoir::getId() const {
     return id;
 }
 
-std::string Reservoir::getCode() const {
+const std::string& Reservoir::getCode() const {
     return code;
 }
 
@@ -16,6 +16,7 @@ private:
     std::string name;
     std::string municipality;
     int maxDelivery; // m³/sec
+    double failureProbability; // chance of the Reservoir being out of service, -1 if the data set gives none
 public:
     /**
      * \brief Reservoir constructor.
@@ -25,26 +26,32 @@ public:
      * @param name The Reservoir name.
      * @param municipality The Reservoir municipality.
      * @param maxDelivery The Reservoir max delivery in m³/sec.
+     * @param failureProbability The chance of the Reservoir being out of service, -1 if not given.
      */
-    Reservoir(int id, std::string code, std::string name, std::string municipality, int maxDelivery): id(id), code(std::move(code)), name(std::move(name)), municipality(std::move(municipality)), maxDelivery(maxDelivery) {};
+    Reservoir(int id, std::string code, std::string name, std::string municipality, int maxDelivery, double failureProbability = -1): id(id), code(std::move(code)), name(std::move(name)), municipality(std::move(municipality)), maxDelivery(maxDelivery), failureProbability(failureProbability) {};
     /**
      * \brief Gets the Reservoir name.
      *
      * @return The Reservoir name.
      */
-    [[nodiscard]] std::string getName() const;
+    [[nodiscard]] const std::string& getName() const;
     /**
      * \brief Gets the Reservoir municipality.
      *
      * @return The Reservoir municipality.
      */
-    [[nodiscard]] std::string getMunicipality() const;
+    [[nodiscard]] const std::string& getMunicipality() const;
     /**
      * \brief Gets the Reservoir max delivery in m³/sec.
      *
      * @return The Reservoir max delivery in m³/sec.
      */
     [[nodiscard]] int getDelivery() const;
+    /**
+     * \brief Gets the chance of the Reservoir being out of service.
+     * @return The Reservoir failure probability, -1 if the data set gives none.
+     */
+    [[nodiscard]] double getFailureProbability() const;
     /**
      * \brief Gets the Reservoir ID.
      *
@@ -56,7 +63,7 @@ public:
      *
      * @return The Reservoir code.
      */
-    [[nodiscard]] std::string getCode() const;
+    [[nodiscard]] const std::string& getCode() const;
     /**
      * \brief Less than operator to compare Reservoir IDs.
      *
@@ -4,6 +4,10 @@ int Station::getId() const {
     return id;
 }
 
-std::string Station::getCode() const {
+const std::string& Station::getCode() const {
     return code;
 }
+
+double Station::getFailureProbability() const {
+    return failureProbability;
+}
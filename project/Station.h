@@ -14,14 +14,16 @@ class Station {
 private:
     int id;
     std::string code;
+    double failureProbability; // chance of the Station being out of service, -1 if the data set gives none
 public:
     /**
      * \brief Station constructor.
      *
      * @param id The Station id.
      * @param code The Station code.
+     * @param failureProbability The chance of the Station being out of service, -1 if not given.
      */
-    Station(int id, std::string code): id(id), code(std::move(code)) {};
+    Station(int id, std::string code, double failureProbability = -1): id(id), code(std::move(code)), failureProbability(failureProbability) {};
     /**
      * \brief Gets the Station ID.
      *
@@ -33,7 +35,13 @@ public:
      *
      * @return The Station code.
      */
-    [[nodiscard]] std::string getCode() const;
+    [[nodiscard]] const std::string& getCode() const;
+    /**
+     * \brief Gets the chance of the Station being out of service.
+     *
+     * @return The Station failure probability, -1 if the data set gives none.
+     */
+    [[nodiscard]] double getFailureProbability() const;
 };
 
 
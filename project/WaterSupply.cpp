@@ -7,9 +7,10 @@
 #include <cmath>
 #include <utility>
 #include <list>
+#include <algorithm>
+#include <filesystem>
 #ifdef _WIN32
 #include <codecvt>
-#include <filesystem>
 
 #endif
 
@@ -27,15 +28,32 @@ unsigned readPopulation(string pop){
     return stoi(res);
 }
 
+double readProbability(const string& column) {
+    // the failure probability columns are optional, -1 marks a missing or invalid value as not given
+    try {
+        double probability = stod(column);
+        return std::isnan(probability) ? -1 : std::clamp(probability, 0.0, 1.0);
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
 /********************** Load  ****************************/
 
 void WaterSupply::load(std::string citiesPath, std::string reservoirsPath, std::string pipesPath, std::string stationsPath) {
+    network.clear();
+    cities.clear();
+    reservoirs.clear();
+    stations.clear();
+    pipeFailures.clear();
+    citySupply.clear();
     loadCities(std::move(citiesPath));
     loadReservoir(std::move(reservoirsPath));
     loadStations(std::move(stationsPath));
     loadPipes(std::move(pipesPath));
     addSuperSource();
     addSuperSink();
+    indexVertices();
     network.resetFlow();
     std::filesystem::create_directory("../output");
 }
@@ -82,16 +100,17 @@ void WaterSupply::loadReservoir(std::string path) {
 #endif
     getline(reservoirsFile, line);
     while (getline(reservoirsFile, line)) {
-        string name, id, code, municipality, maxDelivery;
+        string name, id, code, municipality, maxDelivery, failure;
         istringstream iss(string(line.begin(), line.end()));
         getline(iss, name, ',');
         getline(iss, municipality, ',');
         getline(iss, id, ',');
         getline(iss, code, ',');
         getline(iss, maxDelivery, ',');
+        getline(iss, failure, ',');
         if (!code.empty()) {
             network.addVertex(code);
-            reservoirs.emplace(code, Reservoir(stoi(id), code, name, municipality, stoi(maxDelivery)));
+            reservoirs.emplace(code, Reservoir(stoi(id), code, name, municipality, stoi(maxDelivery), readProbability(failure)));
         }
     }
     reservoirsFile.close();
@@ -103,13 +122,14 @@ void WaterSupply::loadStations(std::string path) {
     string line;
     getline(stationsFile, line);
     while (getline(stationsFile, line)) {
-        string id, code;
+        string id, code, failure;
         istringstream iss(string(line.begin(), line.end()));
         getline(iss, id, ',');
         getline(iss, code, ',');
+        getline(iss, failure, ',');
         if (!code.empty()) {
             network.addVertex(code);
-            stations.emplace(code, Station(stoi(id), code));
+            stations.emplace(code, Station(stoi(id), code, readProbability(failure)));
         }
     }
     stationsFile.close();
@@ -121,46 +141,135 @@ void WaterSupply::loadPipes(std::string path) {
     string line;
     getline(pipesFile, line);
     while (getline(pipesFile, line)) {
-        string a, b, capacity, direction;
+        string a, b, capacity, direction, failure;
         istringstream iss(string(line.begin(), line.end()));
         getline(iss, a, ',');
         getline(iss, b, ',');
         getline(iss, capacity, ',');
-        getline(iss, direction);
+        getline(iss, direction, ',');
+        getline(iss, failure, ',');
         if (stoi(direction)) network.addEdge(a, b, stoi(capacity));
         else network.addBidirectionalEdge(a,b,stoi(capacity));
+        double probability = readProbability(failure);
+        if (probability >= 0) pipeFailures[a + "," + b] = probability;
     }
     pipesFile.close();
 }
 
+void WaterSupply::indexVertices() {
+    cityByVertex.assign(network.getNumVertex(), nullptr);
+    reservoirByVertex.assign(network.getNumVertex(), nullptr);
+    cityIds.clear();
+    reservoirIds.clear();
+    stationIds.clear();
+    for (const auto& c: cities) {
+        unsigned id = network.findVertexId(c.first);
+        cityByVertex[id] = &c.second;
+        cityIds.push_back(id);
+    }
+    for (const auto& r: reservoirs) {
+        unsigned id = network.findVertexId(r.first);
+        reservoirByVertex[id] = &r.second;
+        reservoirIds.push_back(id);
+    }
+    for (const auto& s: stations) {
+        stationIds.push_back(network.findVertexId(s.first));
+    }
+    std::sort(cityIds.begin(), cityIds.end(), [this](unsigned a, unsigned b) {
+        return cityByVertex[a]->getID() < cityByVertex[b]->getID();
+    });
+    std::sort(reservoirIds.begin(), reservoirIds.end(), [this](unsigned a, unsigned b) {
+        return reservoirByVertex[a]->getId() < reservoirByVertex[b]->getId();
+    });
+    std::sort(stationIds.begin(), stationIds.end(), [this](unsigned a, unsigned b) {
+        return stations.at(network.getInfo(a)).getId() < stations.at(network.getInfo(b)).getId();
+    });
+    srcId = network.findVertexId("src");
+    sinkId = network.findVertexId("sink");
+}
+
 /********************** Getters  ****************************/
 
 Graph* WaterSupply::getNetwork() {
     return &network;
 }
 
-City WaterSupply::getCity(const std::string& code) {
+SolverWorkspace& WaterSupply::getWorkspace() {
+    return workspace;
+}
+
+MaxFlowEngine WaterSupply::getEngine() const {
+    return engine;
+}
+
+MinCostEngine WaterSupply::getMinCostEngine() const {
+    return minCostEngine;
+}
+
+const SimplexStats& WaterSupply::getSimplexStats() const {
+    return simplexStats;
+}
+
+const City& WaterSupply::getCity(const std::string& code) const {
     return cities.at(code);
 }
 
-Reservoir WaterSupply::getReservoir(const std::string& code) {
+const City& WaterSupply::getCity(unsigned id) const {
+    return *cityByVertex[id];
+}
+
+const Reservoir& WaterSupply::getReservoir(const std::string& code) const {
     return reservoirs.at(code);
 }
 
-std::unordered_map<std::string, City> WaterSupply::getCities() {
+const Reservoir& WaterSupply::getReservoir(unsigned id) const {
+    return *reservoirByVertex[id];
+}
+
+const std::unordered_map<std::string, City>& WaterSupply::getCities() const {
     return cities;
 }
 
-std::unordered_map<std::string, Reservoir> WaterSupply::getReservoirs() {
+const std::unordered_map<std::string, Reservoir>& WaterSupply::getReservoirs() const {
     return reservoirs;
 }
 
-std::unordered_map<std::string, Station> WaterSupply::getStations() {
+const std::unordered_map<std::string, Station>& WaterSupply::getStations() const {
     return stations;
 }
 
+const std::vector<unsigned>& WaterSupply::getCityIds() const {
+    return cityIds;
+}
+
+const std::vector<unsigned>& WaterSupply::getReservoirIds() const {
+    return reservoirIds;
+}
+
+const std::vector<unsigned>& WaterSupply::getStationIds() const {
+    return stationIds;
+}
+
+double WaterSupply::getPipeFailureProbability(const std::string& source, const std::string& dest) const {
+    auto it = pipeFailures.find(source + "," + dest);
+    if (it == pipeFailures.end()) it = pipeFailures.find(dest + "," + source);
+    return it == pipeFailures.end() ? -1 : it->second;
+}
+
+unsigned WaterSupply::getVertexId(const std::string& code) {
+    return network.findVertexId(code);
+}
+
 /********************** Setters  ****************************/
 
+void WaterSupply::setEngine(MaxFlowEngine engine) {
+    this->engine = engine;
+}
+
+void WaterSupply::setMinCostEngine(MinCostEngine engine) {
+    minCostEngine = engine;
+}
+
 void WaterSupply::addSuperSource() {
     network.addVertex("src");
     for(const auto& v: reservoirs) {
@@ -176,21 +285,21 @@ void WaterSupply::addSuperSink() {
 }
 
 void WaterSupply::setSuperSinkWithDemand() {
-    Vertex* sink = network.findVertex("sink");
+    Vertex* sink = network.findVertex(sinkId);
     for(const auto& e: sink->getIncoming()) {
-        e->setWeight(cities.find(e->getOrig()->getInfo())->second.getDemand());
+        e->setWeight(cityByVertex[e->getOrig()->getId()]->getDemand());
     }
 }
 
 void WaterSupply::setInfSuperSink() {
-    Vertex* sink = network.findVertex("sink");
+    Vertex* sink = network.findVertex(sinkId);
     for(const auto& e: sink->getIncoming()) {
         e->setWeight(INF);
     }
 }
 
 void WaterSupply::setSuperSinkNull() {
-    Vertex* sink = network.findVertex("sink");
+    Vertex* sink = network.findVertex(sinkId);
     for(const auto& e: sink->getIncoming()) {
         e->setWeight(0);
     }
@@ -347,9 +456,9 @@ std::vector<Reservoir> WaterSupply::getReservoirMinDel() {
 
 double WaterSupply::computeMaxDiffCapacityFlow() {
     double maxDiff = 0;
-    for(const auto& v: network.getVertexSet()){
-        if (v.second->getInfo() != "src" && v.second->getInfo().substr(0, 1) != "C") {
-            for (Edge *e: v.second->getAdj()) {
+    for(auto v: network.getVertexSet()){
+        if (v->getId() != srcId && cityByVertex[v->getId()] == nullptr) {
+            for (Edge *e: v->getAdj()) {
                 if (e->checkActive()) {
                     double flow = e->getFlow();
                     if (e->getReverse() && e->getFlow() > e->getReverse()->getFlow()) {
@@ -367,9 +476,9 @@ double WaterSupply::computeMaxDiffCapacityFlow() {
 double WaterSupply::computeAverageDiffCapacityFlow() {
     int n_edges = 0;
     double sum = 0;
-    for(const auto& v: network.getVertexSet()){
-        if (v.second->getInfo() != "src" && v.second->getInfo().substr(0, 1) != "C") {
-            for(Edge* e: v.second->getAdj()){
+    for(auto v: network.getVertexSet()){
+        if (v->getId() != srcId && cityByVertex[v->getId()] == nullptr) {
+            for(Edge* e: v->getAdj()){
                 if (e->checkActive()) {
                     double flow = e->getFlow();
                     if (e->getReverse() && e->getFlow() > e->getReverse()->getFlow()) {
@@ -388,9 +497,9 @@ double WaterSupply::computeAverageDiffCapacityFlow() {
 double WaterSupply::computeVarianceDiffCapacityFlow(double average) {
     int n_edges = 0;
     double square_diff = 0;
-    for(const auto& v: network.getVertexSet()){
-        if (v.second->getInfo() != "src" && v.second->getInfo().substr(0, 1) != "C") {
-            for (Edge *e: v.second->getAdj()) {
+    for(auto v: network.getVertexSet()){
+        if (v->getId() != srcId && cityByVertex[v->getId()] == nullptr) {
+            for (Edge *e: v->getAdj()) {
                 if (e->checkActive()) {
                     double flow = e->getFlow();
                     if (e->getReverse() && e->getFlow() > e->getReverse()->getFlow()) {
@@ -407,6 +516,10 @@ double WaterSupply::computeVarianceDiffCapacityFlow(double average) {
 }
 
 int WaterSupply::computeCityFlow(const std::string& city) {
+    return computeCityFlow(network.findVertexId(city));
+}
+
+int WaterSupply::computeCityFlow(unsigned city) {
     Vertex* end = network.findVertex(city);
     double flow = 0;
     for (Edge* e: end->getIncoming()) {
@@ -417,8 +530,8 @@ int WaterSupply::computeCityFlow(const std::string& city) {
 
 int WaterSupply::computeFlow() {
     double flow = 0;
-    for (const auto& v: cities) {
-        Vertex* end = network.findVertex(v.first);
+    for (unsigned id: cityIds) {
+        Vertex* end = network.findVertex(id);
         double cityFlow = 0;
         for (Edge* e: end->getIncoming()) {
             cityFlow += e->getFlow();
@@ -435,187 +548,256 @@ int WaterSupply::computeFlow() {
 void WaterSupply::maxFlow() {
     setSuperSinkWithDemand();
     network.resetFlow();
-    MaxFlow::maxFlow("src", "sink", &network);
+    MaxFlow::maxFlow(srcId, sinkId, &network, workspace, engine);
 }
 
 void WaterSupply::maxFlowWithExcess() {
     setSuperSinkWithDemand();
     network.resetFlow();
-    MaxFlow::maxFlow("src", "sink", &network);
-    setInfSuperSink();
-    MaxFlow::maxFlow("src", "sink", &network);
+    MaxFlow::maxFlow(srcId, sinkId, &network, workspace, engine);
+    vector<CapacityDelta> deltas;
+    for (Edge* e: network.findVertex(sinkId)->getIncoming()) deltas.push_back({e, INF});
+    MaxFlow::reSolve(srcId, sinkId, &network, workspace, deltas, engine);
 }
 
 void WaterSupply::maxFlowWithExcessToCities(const std::vector<std::string> &target) {
-    setSuperSinkWithDemand();
-    network.resetFlow();
-    MaxFlow::maxFlow("src", "sink", &network);
-    for (const auto& e: target) {
-        network.findEdge(e, "sink")->setWeight(INF);
-    }
-    MaxFlow::maxFlow("src", "sink", &network);
+    vector<unsigned> ids;
+    for (const auto& e: target) ids.push_back(network.findVertexId(e));
+    maxFlowWithExcessToCities(ids);
 }
 
-void WaterSupply::optimalCityMaxFlow(const vector<std::string>& cityList) {
-    setSuperSinkNull();
-    network.resetFlow();
-    for(const auto& city : cityList){
-        network.findEdge(city, "sink")->setWeight(cities.find(city)->second.getDemand());
-        MaxFlow::maxFlow("src", "sink", &network);
-    }
+void WaterSupply::maxFlowWithExcessToCities(const std::vector<unsigned> &target) {
     setSuperSinkWithDemand();
-    MaxFlow::maxFlow("src", "sink", &network);
-}
-
-void WaterSupply::maxFlowToCity(const std::string& target) {
     network.resetFlow();
-    MaxFlow::maxFlow("src", target, &network);
+    MaxFlow::maxFlow(srcId, sinkId, &network, workspace, engine);
+    vector<CapacityDelta> deltas;
+    for (unsigned e: target) deltas.push_back({network.findEdge(e, sinkId), INF});
+    MaxFlow::reSolve(srcId, sinkId, &network, workspace, deltas, engine);
 }
 
-void WaterSupply::OutputToFile(const string& fileName, const string& text){
-    ofstream out(fileName);
-    out << text;
-    out.close();
+void WaterSupply::optimalCityMaxFlow(const vector<std::string>& cityList) {
+    vector<unsigned> ids;
+    for (const auto& city: cityList) ids.push_back(network.findVertexId(city));
+    optimalCityMaxFlow(ids);
 }
 
-void WaterSupply::deleteReservoirMaxReverse(const std::string& reservoir) {
-    maxFlow();
-    MaxFlow::reverseMaxFlow(reservoir, "sink", &network);
-    network.findVertex(reservoir)->desactivate();
-    MaxFlow::maxFlow("src", "sink", &network);
+void WaterSupply::optimalCityMaxFlow(const vector<unsigned>& cityList) {
+    setSuperSinkWithDemand();
+    network.resetFlow();
+    vector<Edge*> targets;
+    for (unsigned city: cityList) targets.push_back(network.findEdge(city, sinkId));
+    MaxFlow::prioritizedMaxFlow(srcId, sinkId, &network, workspace, targets, engine);
 }
 
-bool WaterSupply::existsCode(const std::string& code) {
-    return (cities.count(code) || stations.count(code) || reservoirs.count(code));
+void WaterSupply::maxFlowToCity(const std::string& target) {
+    maxFlowToCity(network.findVertexId(target));
 }
 
-void WaterSupply::activateAll() {
-    for (const auto& v: network.getVertexSet()) {
-        for (auto e: v.second->getAdj()) {
-            e->activate();
+void WaterSupply::maxFlowToCity(unsigned target) {
+    network.resetFlow();
+    MaxFlow::maxFlow(srcId, target, &network, workspace, engine);
+}
+
+/********************** City supply  ****************************/
+
+vector<double> WaterSupply::networkKey() {
+    const FlowGraph& g = *network.getFlowGraph();
+    vector<double> key;
+    key.reserve(g.getNumVertex() + 2 * g.getNumEdge());
+    for (unsigned v = 0; v < g.getNumVertex(); v++) key.push_back(g.getVertex(v)->checkActive());
+    for (unsigned e = 0; e < g.getNumEdge(); e++) {
+        key.push_back(g.getEdge(e)->checkActive());
+        if (g.getDest(e) != sinkId) key.push_back(g.getEdge(e)->getWeight());  // the solves set the sink capacities
+    }
+    return key;
+}
+
+double residualCut(SolverWorkspace& ws, unsigned src, unsigned snk) {
+    // labels the vertices reachable from src in the residual network without the sink and returns the capacity of the
+    // edges leaving them, an upper bound of the max flow to every unlabeled vertex
+    const FlowGraph& g = ws.getGraph();
+    ws.newSearch();
+    ws.label(src);
+    unsigned head = 0, tail = 0;
+    ws.frontier[tail++] = src;
+    while (head < tail) {
+        unsigned u = ws.frontier[head++];
+        for (unsigned a = g.arcBegin(u); a < g.arcEnd(u); a++) {
+            unsigned v = g.head(a);
+            if (v == snk || ws.isLabeled(v) || !ws.isUsable(a) || ws.residual(a) <= 0) continue;
+            ws.label(v);
+            ws.frontier[tail++] = v;
         }
-        v.second->activate();
     }
-}
-
-vector<Edge*> WaterSupply::transformBidirectionalEdges(){
-    vector<Edge*> deactivated;
-    for(const auto& v: network.getVertexSet()){
-        for(auto e : v.second->getAdj()){
-            if(!e->checkActive()) continue;
-            auto reverse = e->getReverse();
-            if(reverse == nullptr || !reverse->checkActive()) continue;
-
-            double resultingFlow = abs(reverse->getFlow() - e->getFlow());
-            reverse->setFlow(reverse->getFlow() > e->getFlow() ? resultingFlow : 0);
-            e->setFlow(reverse->getFlow() == 0 ? resultingFlow : 0);
-
-            if (e->getFlow() == 0) {
-                e->desactivate();
-                deactivated.push_back(e);
-            }
-            else {
-                reverse->desactivate();
-                deactivated.push_back(reverse);
-            }
+    double cut = 0;
+    for (unsigned i = 0; i < tail; i++) {
+        unsigned u = ws.frontier[i];
+        for (unsigned a = g.arcBegin(u); a < g.arcEnd(u); a++) {
+            unsigned v = g.head(a);
+            if (g.isForward(a) && v != snk && !ws.isLabeled(v) && ws.isUsable(a)) cut += ws.capacity[g.edgeOf(a)];
         }
     }
-    return deactivated;
+    return cut;
 }
 
-double differenceCapFlow(Edge* edge) {
-    return edge->getWeight() - edge->getFlow();
-}
-
-double invDifferenceCapFlow(Edge* edge) {
-    return 1/(edge->getWeight() - edge->getFlow());
-}
+const vector<double>& WaterSupply::getMaxCitySupply() {
+    vector<double> key = networkKey();
+    if (!citySupply.empty() && key == supplyKey) return citySupply;
+    supplyKey = std::move(key);
+    unsigned n = cityIds.size();
+    maxFlow();
+    supplySolves = 1;
+    vector<double> lower(n), upper(n);
+    for (unsigned c = 0; c < n; c++) {
+        Vertex* city = network.findVertex(cityIds[c]);
+        lower[c] = network.findEdge(cityIds[c], sinkId)->getFlow();
+        upper[c] = 0;
+        if (!city->checkActive()) continue;
+        for (Edge* e: city->getIncoming()) {
+            if (e->checkActive() && e->getOrig()->checkActive()) upper[c] += e->getWeight();
+        }
+        upper[c] = std::min(upper[c], (double) cityByVertex[cityIds[c]]->getDemand());
+    }
 
-vector<Edge*> WaterSupply::getShortestPathTo(Vertex* city, double (*cost)(Edge*)){
-    auto order = network.topSort();
-    for(auto v: network.getVertexSet()){
-        v.second->setDist(INF);
-        v.second->setPath(nullptr);
-    }
-    auto source = network.findVertex("src");
-    source->setDist(0);
-
-    for(const auto& code : order){
-        if(code == city->getInfo()) break;
-        auto v = network.findVertex(code);
-        for(auto adj : v->getAdj()){
-            if(!adj->checkActive()) continue;
-            double nextCost = v->getDist() + cost(adj);
-            auto w = adj->getDest();
-            if(w->getDist() > nextCost){
-                w->setDist(nextCost);
-                w->setPath(adj);
+    citySupply.assign(n, 0);
+    vector<CapacityDelta> deltas;
+    Edge* open = nullptr;  // the only sink Edge with capacity once the Cities are solved alone
+    for (unsigned c = 0; c < n; c++) {
+        if (upper[c] <= lower[c]) {
+            citySupply[c] = lower[c];
+            continue;
+        }
+        Edge* edge = network.findEdge(cityIds[c], sinkId);
+        deltas.clear();
+        if (open == nullptr) {
+            for (Edge* e: network.findVertex(sinkId)->getIncoming()) {
+                if (e != edge) deltas.push_back({e, -e->getWeight()});
             }
+        } else {
+            deltas.push_back({open, -open->getWeight()});
+            deltas.push_back({edge, (double) cityByVertex[cityIds[c]]->getDemand()});
+        }
+        MaxFlow::reSolve(srcId, sinkId, &network, workspace, deltas, engine);
+        supplySolves++;
+        open = edge;
+        citySupply[c] = edge->getFlow();
+        double cut = residualCut(workspace, srcId, sinkId);
+        for (unsigned d = c + 1; d < n; d++) {
+            if (!workspace.isLabeled(cityIds[d])) upper[d] = std::min(upper[d], cut);
         }
     }
-    vector<Edge*> path;
-    auto curr = city;
-    while(curr->getPath() != nullptr){
-        path.push_back(curr->getPath());
-        curr = curr->getPath()->getOrig();
+    if (open != nullptr) {
+        deltas.clear();
+        for (Edge* e: network.findVertex(sinkId)->getIncoming()) {
+            deltas.push_back({e, cityByVertex[e->getOrig()->getId()]->getDemand() - e->getWeight()});
+        }
+        MaxFlow::reSolve(srcId, sinkId, &network, workspace, deltas, engine);
     }
-    return path;
+    return citySupply;
 }
 
-void WaterSupply::balancingViaMinCost(){
-    for(auto v: network.getVertexSet()){
-        v.second->setVisited(false);
-        v.second->setPath(nullptr);
-    }
-
-    vector<Edge*> deactivated = transformBidirectionalEdges();
-    if(!network.isDAG()) {
-        cout << "NETWORK IS NOT DAG\n";
-    }
-    bool improved;
-    do {
-        improved = false;
-        for(int i = 1; i <= cities.size(); i++){
-            auto city = network.findVertex("C_"+ to_string(i));
-            vector<Edge*> path = getShortestPathTo(city, differenceCapFlow);
+unsigned WaterSupply::getMaxCitySupplySolves() const {
+    return supplySolves;
+}
 
-            if(path.empty() || !PathHasFlow(path)) continue;
-            for(auto e : path){
-                e->setFlow(e->getFlow()-1);
-            }
+void WaterSupply::OutputToFile(const string& fileName, const string& text){
+    ofstream out(fileName);
+    out << text;
+    out.close();
+}
 
-            vector<Edge*> minPath = getShortestPathTo(city, invDifferenceCapFlow);
-            for(auto e : minPath){
-                e->setFlow(e->getFlow()+1);
-            }
+void WaterSupply::deleteReservoirMaxReverse(const std::string& reservoir) {
+    deleteReservoirMaxReverse(network.findVertexId(reservoir));
+}
 
-            bool equals = true;
-            for(int j = 0; j < minPath.size(); j++){
-                if(minPath[j] != path[j]) {
-                    equals = false;
-                    break;
-                }
-            }
-            if(!equals) {
-                i--;
-                improved = true;
-            }
-        }
-    } while( improved );
+void WaterSupply::deleteReservoirMaxReverse(unsigned reservoir) {
+    maxFlow();
+    MaxFlow::reverseMaxFlow(reservoir, sinkId, &network, workspace);
+    network.findVertex(reservoir)->desactivate();
+    MaxFlow::maxFlow(srcId, sinkId, &network, workspace, engine);
+}
 
-    for (auto e: deactivated) {
-        e->activate();
-    }
+bool WaterSupply::existsCode(const std::string& code) {
+    return (cities.count(code) || stations.count(code) || reservoirs.count(code));
 }
 
-bool WaterSupply::PathHasFlow(std::vector<Edge *> path) {
-    return std::all_of(path.begin(), path.end(), [](Edge* e) {return e->getFlow() >= 1;});
+void WaterSupply::activateAll() {
+    for (auto v: network.getVertexSet()) {
+        for (auto e: v->getAdj()) {
+            e->activate();
+        }
+        v->activate();
+    }
+}
+
+double WaterSupply::balancingViaMinCost(){
+    // every City keeps the water it receives, rerouted through the widest pipes: one unit of flow through a pipe costs
+    // the inverse of its capacity, scaled to an integer
+    static constexpr double COST_SCALE = 1 << 20;
+    const FlowGraph& g = *network.getFlowGraph();
+    workspace.attach(g);
+    workspace.load();
+    for (unsigned e = 0; e < g.getNumEdge(); e++) {
+        if (g.getDest(e) == sinkId) workspace.capacity[e] = workspace.flow[e];
+        bool pipe = g.getOrig(e) != srcId && g.getDest(e) != sinkId && workspace.capacity[e] > 0;
+        workspace.cost[e] = pipe ? llround(COST_SCALE / workspace.capacity[e]) : 0;
+    }
+    double cost;
+    if (minCostEngine == MinCostEngine::NETWORK_SIMPLEX) {
+        simplexStats = MinCostFlow::networkSimplex(srcId, sinkId, workspace);
+        cost = simplexStats.cost;
+    } else {
+        cost = MinCostFlow::minCostMaxFlow(srcId, sinkId, workspace);
+    }
+    workspace.store();
+    return cost / COST_SCALE;
+}
+
+VarianceBalance WaterSupply::balancingViaConvexCost() {
+    static constexpr unsigned SEGMENTS = 64;
+    static constexpr unsigned MAX_ROUNDS = 10;
+    const FlowGraph& g = *network.getFlowGraph();
+    workspace.attach(g);
+    workspace.load();
+    VarianceBalance report;
+    double average = computeAverageDiffCapacityFlow();
+    report.initialVariance = report.variance = computeVarianceDiffCapacityFlow(average);
+    // every unit through a pipe also costs 1, so of two routes with the same penalty the shortest is taken
+    vector<double> target(g.getNumEdge(), INF);
+    vector<char> oneSided(g.getNumEdge());
+    for (unsigned e = 0; e < g.getNumEdge(); e++) {
+        if (g.getDest(e) == sinkId) workspace.capacity[e] = workspace.flow[e];
+        workspace.cost[e] = g.getOrig(e) != srcId && g.getDest(e) != sinkId;
+        oneSided[e] = g.getEdge(e)->getReverse() != nullptr;
+    }
+    vector<double> best = workspace.flow;
+    while (report.rounds < MAX_ROUNDS) {
+        for (unsigned e = 0; e < g.getNumEdge(); e++) {
+            if (workspace.cost[e]) target[e] = workspace.capacity[e] - average;
+        }
+        CostScalingStats stats = MinCostFlow::minConvexCostFlow(workspace, target, oneSided, SEGMENTS);
+        report.rounds++;
+        report.work.phases += stats.phases;
+        report.work.pushes += stats.pushes;
+        report.work.relabels += stats.relabels;
+        report.work.cost = stats.cost;
+        workspace.store();
+        double mean = computeAverageDiffCapacityFlow(), variance = computeVarianceDiffCapacityFlow(mean);
+        if (variance >= report.variance) break;
+        report.variance = variance;
+        best = workspace.flow;
+        if (abs(mean - average) < 0.5) break;
+        average = mean;
+    }
+    workspace.flow = best;
+    workspace.store();
+    return report;
 }
 
 string WaterSupply::saveNetwork(){
     stringstream ss;
-    for(const auto& v : network.getVertexSet()){
-        for(auto e :v.second->getAdj()){
+    for(auto v : network.getVertexSet()){
+        for(auto e :v->getAdj()){
             ss << e->getOrig()->getInfo() << "," << e->getDest()->getInfo() << "," << e->getFlow() << '\n';
         }
     }
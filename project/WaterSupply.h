@@ -6,6 +6,17 @@
 #include "Station.h"
 #include "unordered_map"
 #include "MaxFlow.h"
+#include "MinCostFlow.h"
+
+/**
+ * \brief The outcome of WaterSupply::balancingViaConvexCost().
+ */
+struct VarianceBalance {
+    double initialVariance = 0;
+    double variance = 0;        // variance of the capacity - flow of the pipes reached
+    unsigned rounds = 0;        // convex cost flows solved, each around the mean of the previous one
+    CostScalingStats work;      // phases, pushes and relabels summed over the rounds
+};
 
 /**
  * \class WaterSupply
@@ -16,9 +27,23 @@
 class WaterSupply {
 private:
     Graph network;
+    SolverWorkspace workspace;  // scratch state of the solves run on the network by this WaterSupply
+    MaxFlowEngine engine = MaxFlowEngine::EDMONDS_KARP;
+    MinCostEngine minCostEngine = MinCostEngine::SUCCESSIVE_SHORTEST_PATHS;
+    SimplexStats simplexStats;  // work of the last balancing by network simplex
     std::unordered_map<std::string, City> cities;
     std::unordered_map<std::string, Reservoir> reservoirs;
     std::unordered_map<std::string, Station> stations;
+    std::unordered_map<std::string, double> pipeFailures;  // failure probability of the pipes the data set gives one for, keyed by "origin,destination"
+    std::vector<unsigned> cityIds;       // Vertex IDs of the City, ordered by City ID
+    std::vector<unsigned> reservoirIds;  // Vertex IDs of the Reservoir, ordered by Reservoir ID
+    std::vector<unsigned> stationIds;    // Vertex IDs of the Station, ordered by Station ID
+    std::vector<const City*> cityByVertex;            // City of each Vertex ID, nullptr if not a City
+    std::vector<const Reservoir*> reservoirByVertex;  // Reservoir of each Vertex ID, nullptr if not a Reservoir
+    unsigned srcId = 0, sinkId = 0;
+    std::vector<double> citySupply;  // max flow each City can receive alone, ordered like cityIds, empty until computed
+    std::vector<double> supplyKey;   // active state and capacities of the network citySupply was computed for
+    unsigned supplySolves = 0;       // max flow solves the last computation of citySupply needed
 
     /**
      * \brief Loads all the City data from the file in the given file path.
@@ -44,10 +69,24 @@ private:
      * @param path The file path of the file to load the Pipe data from.
      */
     void loadPipes(std::string path);
+    /**
+     * \brief Builds the Vertex ID indexes of all City, Reservoir and Station.
+     */
+    void indexVertices();
+    /**
+     * \brief Gets the active state of every Vertex and Edge and the capacity of every Edge that does not reach the
+     * super sink, used to detect changes of the network.
+     *
+     * @return The state of the network.
+     * \par Complexity
+     * O(V + E) in which V is the number of vertex and E the number of edges of the Graph.
+     */
+    std::vector<double> networkKey();
 
 public:
     /**
-     * \brief Parses the Cities, pipes, reservoirs and stations input files into appropriate data structures.
+     * \brief Parses the Cities, pipes, reservoirs and stations input files into appropriate data structures,
+     * replacing the previously loaded network if any.
      *
      * @param citiesPath The path of the cities information input file.
      * @param reservoirsPath The path of the reservoirs information input file.
@@ -58,6 +97,18 @@ public:
     void load(std::string citiesPath, std::string reservoirsPath, std::string pipesPath, std::string stationsPath);
 
     /********************** Setters  ****************************/
+    /**
+     * \brief Sets the algorithm used to compute the max flow of the network.
+     *
+     * @param engine The max flow engine to use.
+     */
+    void setEngine(MaxFlowEngine engine);
+    /**
+     * \brief Sets the algorithm used to compute the min-cost flow of balancingViaMinCost().
+     *
+     * @param engine The min-cost engine to use.
+     */
+    void setMinCostEngine(MinCostEngine engine);
     /**
      * \brief Creates a superSource vertex connected to each reservoir by an Edge with capacity equal to their max Delivery.
      */
@@ -78,38 +129,109 @@ public:
      * @return The Graph of the network.
      */
     Graph* getNetwork();
+    /**
+     * \brief Gets the workspace used by the solves of this WaterSupply.
+     *
+     * @return The workspace of the network.
+     */
+    SolverWorkspace& getWorkspace();
+    /**
+     * \brief Gets the algorithm used to compute the max flow of the network.
+     *
+     * @return The max flow engine.
+     */
+    MaxFlowEngine getEngine() const;
+    /**
+     * \brief Gets the algorithm used to compute the min-cost flow of balancingViaMinCost().
+     *
+     * @return The min-cost engine.
+     */
+    MinCostEngine getMinCostEngine() const;
+    /**
+     * \brief Gets the work done by the last balancingViaMinCost() run by network simplex.
+     *
+     * @return The pivots made and whether the run started from the previous basis.
+     */
+    const SimplexStats& getSimplexStats() const;
     /**
      * \brief Gets the City with the specified code.
      *
      * @param code The code of the City to get.
      * @return The City with the specified code.
      */
-    City getCity(const std::string& code);
+    const City& getCity(const std::string& code) const;
+    /**
+     * \brief Gets the City of the Vertex with the specified ID.
+     *
+     * @param id The Vertex ID of the City to get.
+     * @return The City of the Vertex with the specified ID.
+     */
+    const City& getCity(unsigned id) const;
     /**
      * \brief Gets the Reservoir with the specified code.
      *
      * @param code The code of the Reservoir to get.
      * @return The Reservoir with the specified code.
      */
-    Reservoir getReservoir(const std::string& code);
+    const Reservoir& getReservoir(const std::string& code) const;
+    /**
+     * \brief Gets the Reservoir of the Vertex with the specified ID.
+     *
+     * @param id The Vertex ID of the Reservoir to get.
+     * @return The Reservoir of the Vertex with the specified ID.
+     */
+    const Reservoir& getReservoir(unsigned id) const;
     /**
      * \brief Gets all the City of the network.
      *
      * @return A mapping of code to City of all City in the network.
      */
-    std::unordered_map<std::string, City> getCities();
+    const std::unordered_map<std::string, City>& getCities() const;
     /**
      * \brief Gets all the Reservoir of the network.
      *
      * @return A mapping of code to Reservoir of all Reservoir in the network.
      */
-    std::unordered_map<std::string, Reservoir> getReservoirs();
+    const std::unordered_map<std::string, Reservoir>& getReservoirs() const;
     /**
      * \brief Gets all the Station of the network.
      *
      * @return A mapping of codes to Station of all Station in the network.
      */
-    std::unordered_map<std::string, Station> getStations();
+    const std::unordered_map<std::string, Station>& getStations() const;
+    /**
+     * \brief Gets the Vertex IDs of all the City of the network, ordered by City ID.
+     *
+     * @return The Vertex IDs of all the City.
+     */
+    const std::vector<unsigned>& getCityIds() const;
+    /**
+     * \brief Gets the Vertex IDs of all the Reservoir of the network, ordered by Reservoir ID.
+     *
+     * @return The Vertex IDs of all the Reservoir.
+     */
+    const std::vector<unsigned>& getReservoirIds() const;
+    /**
+     * \brief Gets the Vertex IDs of all the Station of the network, ordered by Station ID.
+     *
+     * @return The Vertex IDs of all the Station.
+     */
+    const std::vector<unsigned>& getStationIds() const;
+    /**
+     * \brief Gets the chance of the pipe between the given service points being out of service.
+     *
+     * @param source The code of one end of the pipe.
+     * @param dest The code of the other end of the pipe.
+     * @return The pipe failure probability, -1 if the pipes file gave none.
+     */
+    double getPipeFailureProbability(const std::string& source, const std::string& dest) const;
+    /**
+     * \brief Gets the Vertex ID of the Reservoir, City or Station with the given code.
+     *
+     * @param code The code to look up.
+     * @return The Vertex ID of the given code.
+     */
+    unsigned getVertexId(const std::string& code);
 
     /********************** Checkers  ****************************/
     /**
@@ -231,6 +353,13 @@ public:
      * @return The City's incoming flow value.
      */
     int computeCityFlow(const std::string& city);
+    /**
+     * \brief Computes the incoming flow value of the City with the given Vertex ID.
+     *
+     * @param city The Vertex ID of the City whose incoming flow will be computed.
+     * @return The City's incoming flow value.
+     */
+    int computeCityFlow(unsigned city);
 
     /********************** MaxFlow  ****************************/
     /**
@@ -247,12 +376,24 @@ public:
      * @param target Vector of the City to add excess flow.
      */
     void maxFlowWithExcessToCities(const std::vector<std::string> &target);
+    /**
+     * \brief Sets up the sink and source Vertex and calls the maxflow function of MaxFlow to perform a maxflow with excess to all the given City only.
+     *
+     * @param target Vector of the Vertex IDs of the City to add excess flow.
+     */
+    void maxFlowWithExcessToCities(const std::vector<unsigned> &target);
     /**
      * \brief Calls the maxflow function of MaxFlow to perform a maxflow with sink of only the City with the given code.
      *
      * @param target The code of the City sink.
      */
     void maxFlowToCity(const std::string& target);
+    /**
+     * \brief Calls the maxflow function of MaxFlow to perform a maxflow with sink of only the City with the given Vertex ID.
+     *
+     * @param target The Vertex ID of the City sink.
+     */
+    void maxFlowToCity(unsigned target);
 
     /********************** MaxFlow Reverse ****************************/
     /**
@@ -261,6 +402,12 @@ public:
      * @param reservoir The Reservoir to delete.
      */
     void deleteReservoirMaxReverse(const std::string& reservoir);
+    /**
+     * \brief Deletes the Reservoir with the given Vertex ID and recomputes the max flow using the reverseMaxFlow method.
+     *
+     * @param reservoir The Vertex ID of the Reservoir to delete.
+     */
+    void deleteReservoirMaxReverse(unsigned reservoir);
     /**
      * \brief Outputs the given string to the file with the given file name.
      *
@@ -295,35 +442,37 @@ public:
      */
     void activateAll();
     /**
-     * \brief Transforms all bidirectional Edge to be one directional without altering the current flow of the Graph.
+     * \brief Balances the capacity - flow across the Graph, keeping the flow each City receives.
      *
-     * @return The deactivated part of all the bidirectional Edge.
-     */
-    std::vector<Edge*> transformBidirectionalEdges();
-    /**
-     * \brief Balances the demand - flow across the Graph.
+     * The flow is solved again as a min-cost flow in which one unit through a pipe costs the inverse of its capacity,
+     * so the water is routed through the pipes with the most capacity and opposite flows in a bidirectional pipe
+     * cancel out. With the network simplex engine, balancing again after a change of the network starts from the
+     * basis of the previous balancing.
      *
-     * \par Complexity
-     * O(E|f*|) in which E is the number of edges of the graph and |f*| is limited by the value of the maximum flow.
-     */
-    void balancingViaMinCost();
-    /**
-     * \brief Finds the shortest path to the given City Vertex using the given function to calculate the distance.
+     * @return The cost of the balanced flow, the sum of flow / capacity of the pipes.
      *
-     * @param city The City vertex to calculate the shortest path to.
-     * @param func The function to calculate the distance.
-     * @return The shortest path to the given City Vertex using the given function to calculate the distance.
      * \par Complexity
-     * O(V+E) in which V is the number of vertex and E the number of edges of the Graph.
+     * O(P (E + V) log V) in which P is the number of augmenting paths of the min-cost flow, V the number of vertex and
+     * E the number of edges of the Graph, or O(P (√E + V)) for P pivots of the network simplex.
      */
-    std::vector<Edge *> getShortestPathTo(Vertex* city, double (*func)(Edge*));
+    double balancingViaMinCost();
     /**
-     * \brief Checks if the given path has any flow.
+     * \brief Reroutes the flow to minimize the variance of the capacity - flow of the pipes, keeping the flow each
+     * City receives.
+     *
+     * The variance is the least sum of squares around a mean, so each round fixes the mean spare capacity and solves
+     * the convex cost flow that pulls the flow of every pipe towards capacity - mean, with a quadratic penalty. The
+     * variance of a bidirectional pipe only sees its net flow, so it is penalized above the target but not pulled up to
+     * it, which would only send water both ways. The next round uses the mean of the new flow, until the variance
+     * stops decreasing; the best flow is kept.
+     *
+     * @return The variance before and after, and the work done by the rounds.
      *
-     * @param path The path to check.
-     * @return True if the given path has any flow, false otherwise.
+     * \par Complexity
+     * O(R V² A log(VC)) in which R is the number of rounds, V the number of vertex, A the number of pipe segments and
+     * C the largest pipe capacity.
      */
-    static bool PathHasFlow(std::vector<Edge*> path);
+    VarianceBalance balancingViaConvexCost();
     /**
      * \brief Sets all Edge from City to super sink capacity to the respective City demand.
      */
@@ -334,6 +483,39 @@ public:
      * @param cityList The City list to calculate the optimal max flow to.
      */
     void optimalCityMaxFlow(const std::vector<std::string> &cityList);
+    /**
+     * \brief Calculates the optimal max flow to the given City list ignoring every other City.
+     *
+     * Every City of the list receives as much water as possible without taking any from the Cities before it, in a
+     * single incremental pass; the other Cities then share what is left.
+     *
+     * @param cityList The Vertex IDs of the City list to calculate the optimal max flow to.
+     * \par Complexity
+     * O(PE + CV) in which P is the number of augmenting paths to the Cities of the list and C their number, V the
+     * number of vertex and E the number of edges of the Graph, plus one warm-started max flow.
+     */
+    void optimalCityMaxFlow(const std::vector<unsigned> &cityList);
+    /**
+     * \brief Gets the max flow each City can receive when every other City is ignored, i.e. the City flow
+     * optimalCityMaxFlow() gives when it is the only City of the list.
+     *
+     * The flow of every City when all of them are served at once is a lower bound of its answer, and its demand and
+     * the capacity of its pipes are upper bounds. Only the Cities whose bounds differ are solved, each one warm started
+     * from the flow of the previous one, and the min cut of each solve bounds the Cities it separates from the source.
+     * The answers are cached until the active state or a capacity of the network changes, and the Graph is left with
+     * the max flow of all the Cities when they are computed.
+     *
+     * @return The max flow of each City, ordered like getCityIds().
+     * \par Complexity
+     * O(V + E) when cached, O(K F) otherwise, in which K is the number of solves and F the cost of a warm-started solve.
+     */
+    const std::vector<double>& getMaxCitySupply();
+    /**
+     * \brief Gets the number of max flow solves the last computation of getMaxCitySupply() needed.
+     *
+     * @return The number of solves.
+     */
+    unsigned getMaxCitySupplySolves() const;
     /**
      * \brief Sets all Edge from City to super sink capacity to 0.
      */
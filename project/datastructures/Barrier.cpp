@@ -0,0 +1,15 @@
+#include "Barrier.h"
+
+Barrier::Barrier(unsigned count): count(count) {}
+
+void Barrier::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned long arrived = generation;
+    if (++waiting == count) {
+        waiting = 0;
+        generation++;
+        released.notify_all();
+    } else {
+        released.wait(lock, [this, arrived] { return generation != arrived; });
+    }
+}
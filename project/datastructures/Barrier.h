@@ -0,0 +1,31 @@
+#ifndef WATERSUPPLYMANAGER_BARRIER_H
+#define WATERSUPPLYMANAGER_BARRIER_H
+
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * \class Barrier
+ * \brief A reusable barrier that blocks threads until a fixed number of them reach it.
+ */
+class Barrier {
+private:
+    std::mutex mutex;
+    std::condition_variable released;
+    unsigned count;
+    unsigned waiting = 0;
+    unsigned long generation = 0;
+public:
+    /**
+     * \brief Barrier constructor.
+     *
+     * @param count The number of threads that have to call wait() before any of them is released.
+     */
+    explicit Barrier(unsigned count);
+    /**
+     * \brief Blocks until count threads are waiting on the barrier, then releases all of them.
+     */
+    void wait();
+};
+
+#endif //WATERSUPPLYMANAGER_BARRIER_H
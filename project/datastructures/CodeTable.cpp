@@ -0,0 +1,21 @@
+#include "CodeTable.h"
+
+unsigned CodeTable::intern(const std::string& code) {
+    auto it = ids.emplace(code, codes.size());
+    if (it.second) codes.push_back(code);
+    return it.first->second;
+}
+
+unsigned CodeTable::find(const std::string& code) const {
+    auto it = ids.find(code);
+    return it != ids.end() ? it->second : NONE;
+}
+
+void CodeTable::erase(unsigned id) {
+    ids.erase(codes[id]);
+    if (id != codes.size() - 1) {
+        codes[id] = std::move(codes.back());
+        ids[codes[id]] = id;
+    }
+    codes.pop_back();
+}
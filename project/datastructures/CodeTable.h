@@ -0,0 +1,66 @@
+#ifndef WATERSUPPLYMANAGER_CODETABLE_H
+#define WATERSUPPLYMANAGER_CODETABLE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+
+/**
+ * \class CodeTable
+ * \brief A symbol table that interns codes such as "PS_17" into dense integer IDs.
+ *
+ * Each code is hashed once, when it is interned; afterwards it can be referred to by its ID and the code string is only
+ * needed again for output.
+ */
+class CodeTable {
+private:
+    std::unordered_map<std::string, unsigned> ids;
+    std::vector<std::string> codes;
+public:
+    /**
+     * \brief The value returned by find() for codes that are not in the table.
+     */
+    static constexpr unsigned NONE = std::numeric_limits<unsigned>::max();
+    /**
+     * \brief Interns the given code.
+     *
+     * @param code The code to intern.
+     * @return The ID of the code, which is the number of codes in the table if the code is new.
+     *
+     * \par Complexity
+     * O(L) average in which L is the length of the code.
+     */
+    unsigned intern(const std::string& code);
+    /**
+     * \brief Finds the ID of the given code.
+     *
+     * @param code The code to find.
+     * @return The ID of the code or NONE if the code is not in the table.
+     *
+     * \par Complexity
+     * O(L) average in which L is the length of the code.
+     */
+    unsigned find(const std::string& code) const;
+    /**
+     * \brief Gets the code with the given ID.
+     *
+     * @param id The ID of the code.
+     * @return The code with the given ID.
+     */
+    const std::string& getCode(unsigned id) const { return codes[id]; }
+    /**
+     * \brief Removes the code with the given ID, giving its ID to the last code in the table so IDs stay dense.
+     *
+     * @param id The ID of the code to remove.
+     */
+    void erase(unsigned id);
+    /**
+     * \brief Gets the number of codes in the table.
+     *
+     * @return The number of codes in the table.
+     */
+    unsigned size() const { return codes.size(); }
+};
+
+#endif //WATERSUPPLYMANAGER_CODETABLE_H
@@ -0,0 +1,27 @@
+#include "FlowGraph.h"
+
+FlowGraph::FlowGraph(const Graph& graph) : vertices(graph.getVertexSet()) {
+    for (Vertex* v: vertices) {
+        for (Edge* e: v->getAdj()) {
+            e->setId(edges.size());
+            edges.push_back(e);
+            edgeOrig.push_back(e->getOrig()->getId());
+            edgeDest.push_back(e->getDest()->getId());
+        }
+    }
+    offset.reserve(vertices.size() + 1);
+    arcHead.reserve(2 * edges.size());
+    arcEdge.reserve(2 * edges.size());
+    offset.push_back(0);
+    for (Vertex* v: vertices) {
+        for (Edge* e: v->getAdj()) {
+            arcHead.push_back(e->getDest()->getId());
+            arcEdge.push_back(e->getId() << 1);
+        }
+        for (Edge* e: v->getIncoming()) {
+            arcHead.push_back(e->getOrig()->getId());
+            arcEdge.push_back(e->getId() << 1 | 1);
+        }
+        offset.push_back(arcHead.size());
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef WATERSUPPLYMANAGER_FLOWGRAPH_H
+#define WATERSUPPLYMANAGER_FLOWGRAPH_H
+
+#include <vector>
+#include "Graph.h"
+
+/**
+ * \class FlowGraph
+ * \brief A compressed sparse row (CSR) representation of the topology of a Graph used by the flow algorithms.
+ *
+ * Vertex keep their Graph IDs and every Edge receives a dense integer ID. The residual arcs of each Vertex are stored
+ * contiguously: first one forward arc for each outgoing Edge, then one reverse arc for each incoming Edge, in the same
+ * order as the Vertex adjacency lists. A FlowGraph is never modified after it is built, so any number of
+ * SolverWorkspace can run over it at the same time; capacities, flows and active states live in the workspace.
+ */
+class FlowGraph {
+private:
+    std::vector<Vertex*> vertices;
+    std::vector<Edge*> edges;
+
+    std::vector<unsigned> offset;   // arcs of vertex v are [offset[v], offset[v+1])
+    std::vector<unsigned> arcHead;  // vertex reached by the arc
+    std::vector<unsigned> arcEdge;  // (edge ID << 1) | 1 if the arc traverses the edge backwards
+
+    std::vector<unsigned> edgeOrig;
+    std::vector<unsigned> edgeDest;
+public:
+    /**
+     * \brief Builds the CSR representation of the given Graph, assigning dense IDs to all its Edge.
+     *
+     * @param graph The Graph to pack.
+     *
+     * \par Complexity
+     * O(V + E) in which V is the number of vertex and E the number of edges of the Graph.
+     */
+    explicit FlowGraph(const Graph& graph);
+    /**
+     * \brief Gets the number of Vertex.
+     *
+     * @return The number of Vertex.
+     */
+    unsigned getNumVertex() const { return vertices.size(); }
+    /**
+     * \brief Gets the number of Edge.
+     *
+     * @return The number of Edge.
+     */
+    unsigned getNumEdge() const { return edges.size(); }
+    /**
+     * \brief Gets the Vertex with the given ID.
+     *
+     * @param v The Vertex ID.
+     * @return The Vertex with the given ID.
+     */
+    Vertex* getVertex(unsigned v) const { return vertices[v]; }
+    /**
+     * \brief Gets the Edge with the given ID.
+     *
+     * @param e The Edge ID.
+     * @return The Edge with the given ID.
+     */
+    Edge* getEdge(unsigned e) const { return edges[e]; }
+    /**
+     * \brief Gets the first residual arc of the given Vertex.
+     *
+     * @param v The Vertex ID.
+     * @return The index of the first arc of the Vertex.
+     */
+    unsigned arcBegin(unsigned v) const { return offset[v]; }
+    /**
+     * \brief Gets the index after the last residual arc of the given Vertex.
+     *
+     * @param v The Vertex ID.
+     * @return The index after the last arc of the Vertex.
+     */
+    unsigned arcEnd(unsigned v) const { return offset[v + 1]; }
+    /**
+     * \brief Gets the Vertex reached by the given arc.
+     *
+     * @param a The arc index.
+     * @return The ID of the Vertex reached by the arc.
+     */
+    unsigned head(unsigned a) const { return arcHead[a]; }
+    /**
+     * \brief Gets the Edge traversed by the given arc.
+     *
+     * @param a The arc index.
+     * @return The ID of the Edge traversed by the arc.
+     */
+    unsigned edgeOf(unsigned a) const { return arcEdge[a] >> 1; }
+    /**
+     * \brief Checks if the given arc traverses its Edge in the Edge's direction.
+     *
+     * @param a The arc index.
+     * @return True if the arc goes from the Edge origin to the Edge destination, false otherwise.
+     */
+    bool isForward(unsigned a) const { return !(arcEdge[a] & 1); }
+    /**
+     * \brief Gets the Vertex the given arc leaves from.
+     *
+     * @param a The arc index.
+     * @return The ID of the Vertex the arc leaves from.
+     */
+    unsigned tail(unsigned a) const { return isForward(a) ? edgeOrig[edgeOf(a)] : edgeDest[edgeOf(a)]; }
+    /**
+     * \brief Gets the origin Vertex of the given Edge.
+     *
+     * @param e The Edge ID.
+     * @return The ID of the origin Vertex of the Edge.
+     */
+    unsigned getOrig(unsigned e) const { return edgeOrig[e]; }
+    /**
+     * \brief Gets the destination Vertex of the given Edge.
+     *
+     * @param e The Edge ID.
+     * @return The ID of the destination Vertex of the Edge.
+     */
+    unsigned getDest(unsigned e) const { return edgeDest[e]; }
+};
+
+#endif //WATERSUPPLYMANAGER_FLOWGRAPH_H
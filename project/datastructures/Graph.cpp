@@ -1,4 +1,6 @@
 #include "Graph.h"
+#include "FlowGraph.h"
+#include "SolverWorkspace.h"
 
 #include <utility>
 #include <stack>
@@ -12,9 +14,11 @@ Vertex::Vertex(std::string in): info(std::move(in)) {}
  * with a given destination vertex (d) and edge weight (w).
  */
 
-Edge * Vertex::addEdge(Vertex *d, double w) {
-    auto newEdge = new Edge(this, d, w);
+Edge * Vertex::addEdge(Vertex *d, double w, Pool<Edge>& pool) {
+    auto newEdge = pool.create(this, d, w);
+    newEdge->adjSlot = adj.size();
     adj.push_back(newEdge);
+    newEdge->incomingSlot = d->incoming.size();
     d->incoming.push_back(newEdge);
     return newEdge;
 }
@@ -25,19 +29,16 @@ Edge * Vertex::addEdge(Vertex *d, double w) {
  * Returns true if successful, and false if such edge does not exist.
  */
 
-bool Vertex::removeEdge(const std::string& in) {
+bool Vertex::removeEdge(const std::string& in, Pool<Edge>& pool) {
     bool removedEdge = false;
-    auto it = adj.begin();
-    while (it != adj.end()) {
-        Edge *edge = *it;
-        Vertex *dest = edge->getDest();
-        if (dest->getInfo() == in) {
-            it = adj.erase(it);
-            deleteEdge(edge);
+    unsigned i = 0;
+    while (i < adj.size()) {
+        if (adj[i]->getDest()->getInfo() == in) {
+            deleteEdge(adj[i], pool); // moves the last edge into slot i
             removedEdge = true; // allows for multiple edges to connect the same pair of vertices (multigraph)
         }
         else {
-            it++;
+            i++;
         }
     }
     return removedEdge;
@@ -47,50 +48,41 @@ bool Vertex::removeEdge(const std::string& in) {
  * Auxiliary function to remove an outgoing edge of a vertex.
  */
 
-void Vertex::removeOutgoingEdges() {
-    auto it = adj.begin();
-    while (it != adj.end()) {
-        Edge *edge = *it;
-        it = adj.erase(it);
-        deleteEdge(edge);
+void Vertex::removeOutgoingEdges(Pool<Edge>& pool) {
+    while (!adj.empty()) {
+        deleteEdge(adj.back(), pool);
     }
 }
 
+/*
+ * Auxiliary function to remove an incoming edge of a vertex.
+ */
 
-bool Vertex::operator<(Vertex & vertex) const {
-    return this->dist < vertex.dist;
+void Vertex::removeIncomingEdges(Pool<Edge>& pool) {
+    while (!incoming.empty()) {
+        deleteEdge(incoming.back(), pool);
+    }
 }
 
-std::string
+
+const std::string&
 Vertex::getInfo() const {
     return this->info;
 }
 
-std::vector<Edge*> Vertex::getAdj() const {
-    return this->adj;
-}
-
-bool Vertex::isVisited() const {
-    return this->visited;
-}
-
-bool Vertex::isProcessing() const {
-    return this->processing;
+unsigned Vertex::getId() const {
+    return this->id;
 }
 
-unsigned int Vertex::getIndegree() const {
-    return this->indegree;
+void Vertex::setId(unsigned id) {
+    this->id = id;
 }
 
-double Vertex::getDist() const {
-    return this->dist;
-}
-
-Edge *Vertex::getPath() const {
-    return this->path;
+const std::vector<Edge*>& Vertex::getAdj() const {
+    return this->adj;
 }
 
-std::vector<Edge *> Vertex::getIncoming() const {
+const std::vector<Edge *>& Vertex::getIncoming() const {
     return this->incoming;
 }
 
@@ -98,55 +90,18 @@ void Vertex::setInfo(std::string in) {
     this->info = std::move(in);
 }
 
-void Vertex::setVisited(bool visited) {
-    this->visited = visited;
-}
-
-void Vertex::setProcessing(bool processing) {
-    this->processing = processing;
-}
-
-void Vertex::setIndegree(unsigned int indegree) {
-    this->indegree = indegree;
-}
-
-void Vertex::setDist(double dist) {
-    this->dist = dist;
-}
-
-void Vertex::setPath(Edge *path) {
-    this->path = path;
-}
-
-void Vertex::deleteEdge(Edge *edge) {
-    Vertex *dest = edge->getDest();
-    // Remove the corresponding edge from the incoming list
-    auto it = dest->incoming.begin();
-    while (it != dest->incoming.end()) {
-        if ((*it)->getOrig()->getInfo() == info) {
-            it = dest->incoming.erase(it);
-        }
-        else {
-            it++;
-        }
-    }
-    delete edge;
-}
-
-std::unordered_set<int> Vertex::getPaths() {
-    return paths;
-}
-
-void Vertex::addPath(int p) {
-    paths.emplace(p);
-}
-
-void Vertex::removePath(int p) {
-    paths.erase(p);
-}
-
-void Vertex::resetPath() {
-    paths.clear();
+void Vertex::deleteEdge(Edge *edge, Pool<Edge>& pool) {
+    // Swap the edge with the last one of each list, so the removal does not shift the other edges
+    std::vector<Edge *>& out = edge->orig->adj;
+    out[edge->adjSlot] = out.back();
+    out[edge->adjSlot]->adjSlot = edge->adjSlot;
+    out.pop_back();
+    std::vector<Edge *>& in = edge->dest->incoming;
+    in[edge->incomingSlot] = in.back();
+    in[edge->incomingSlot]->incomingSlot = edge->incomingSlot;
+    in.pop_back();
+    if (edge->reverse != nullptr) edge->reverse->reverse = nullptr;
+    pool.destroy(edge);
 }
 
 void Vertex::activate() {
@@ -166,6 +121,14 @@ bool Vertex::checkActive() {
 
 Edge::Edge(Vertex *orig, Vertex *dest, double w): orig(orig), dest(dest), weight(w) {}
 
+unsigned Edge::getId() const {
+    return this->id;
+}
+
+void Edge::setId(unsigned id) {
+    this->id = id;
+}
+
 Vertex * Edge::getDest() const {
     return this->dest;
 }
@@ -198,27 +161,6 @@ void Edge::setWeight(double weight) {
     this->weight = weight;
 }
 
-std::unordered_set<int> Edge::getPaths() {
-    return paths;
-}
-
-void Edge::addPath(int p) {
-    paths.emplace(p);
-
-}
-
-void Edge::removePath(int p) {
-    paths.erase(p);
-}
-
-void Edge::resetPath() {
-    paths.clear();
-}
-
-bool Edge::hasPath(int p) {
-    return paths.count(p);
-}
-
 void Edge::desactivate() {
     isActive = false;
 }
@@ -231,14 +173,6 @@ bool Edge::checkActive() const {
     return isActive;
 }
 
-bool Edge::checkVisited() const {
-    return visited;
-}
-
-void Edge::setVisited(bool newVisited) {
-    visited = newVisited;
-}
-
 /********************** Graph  ****************************/
 
 
@@ -246,7 +180,7 @@ int Graph::getNumVertex() const {
     return vertexSet.size();
 }
 
-std::unordered_map<std::string, Vertex*> Graph::getVertexSet() const {
+const std::vector<Vertex*>& Graph::getVertexSet() const {
     return vertexSet;
 }
 
@@ -254,10 +188,21 @@ std::unordered_map<std::string, Vertex*> Graph::getVertexSet() const {
  * Auxiliary function to find a vertex with a given content.
  */
 Vertex* Graph::findVertex(const std::string&in) const {
-    auto it = vertexSet.find(in);
-    return (it != vertexSet.end()) ? it->second : nullptr;
+    unsigned id = codes.find(in);
+    return (id != CodeTable::NONE) ? vertexSet[id] : nullptr;
+}
+
+Vertex* Graph::findVertex(unsigned id) const {
+    return vertexSet[id];
 }
 
+unsigned Graph::findVertexId(const std::string &in) const {
+    return codes.find(in);
+}
+
+const std::string &Graph::getInfo(unsigned id) const {
+    return codes.getCode(id);
+}
 
 /*
  *  Adds a vertex with a given content or info (in) to a graph (this).
@@ -265,7 +210,10 @@ Vertex* Graph::findVertex(const std::string&in) const {
  */
 bool Graph::addVertex(const std::string &in) {
     if(findVertex(in) != nullptr) return false;
-    vertexSet.emplace(in, new Vertex(in));
+    auto v = vertexPool.create(in);
+    v->setId(codes.intern(in));
+    vertexSet.push_back(v);
+    invalidateFlowGraph();
     return true;
 }
 
@@ -276,15 +224,17 @@ bool Graph::addVertex(const std::string &in) {
  */
 
 bool Graph::removeVertex(const std::string& in) {
-    auto it = vertexSet.find(in);
-    if (it != vertexSet.end()) {
-        Vertex* v = it->second;
-        v->removeOutgoingEdges();
-        for (auto u: vertexSet) {
-            (u.second)->removeEdge(v->getInfo());
-        }
-        vertexSet.erase(it);
-        delete v;
+    unsigned id = codes.find(in);
+    if (id != CodeTable::NONE) {
+        Vertex* v = vertexSet[id];
+        v->removeOutgoingEdges(edgePool);
+        v->removeIncomingEdges(edgePool);
+        codes.erase(id);
+        vertexSet[id] = vertexSet.back();
+        vertexSet[id]->setId(id);
+        vertexSet.pop_back();
+        vertexPool.destroy(v);
+        invalidateFlowGraph();
         return true;
     }
     return false;
@@ -296,24 +246,26 @@ bool Graph::removeVertex(const std::string& in) {
  * Returns true if successful, and false if the source or destination vertex does not exist.
  */
 
-bool Graph::addEdge(const std::string &sourc, const std::string& dest, double w) const {
+bool Graph::addEdge(const std::string &sourc, const std::string& dest, double w) {
     auto v1 = findVertex(sourc);
     auto v2 = findVertex(dest);
     if (v1 == nullptr || v2 == nullptr)
         return false;
-    v1->addEdge(v2, w);
+    v1->addEdge(v2, w, edgePool);
+    invalidateFlowGraph();
     return true;
 }
 
-bool Graph::addBidirectionalEdge(const std::string& sourc, const std::string& dest, double w) const {
+bool Graph::addBidirectionalEdge(const std::string& sourc, const std::string& dest, double w) {
     auto v1 = findVertex(sourc);
     auto v2 = findVertex(dest);
     if (v1 == nullptr || v2 == nullptr)
         return false;
-    auto e1 = v1->addEdge(v2, w);
-    auto e2 = v2->addEdge(v1, w);
+    auto e1 = v1->addEdge(v2, w, edgePool);
+    auto e2 = v2->addEdge(v1, w, edgePool);
     e1->setReverse(e2);
     e2->setReverse(e1);
+    invalidateFlowGraph();
     return true;
 }
 
@@ -326,14 +278,13 @@ bool Graph::addBidirectionalEdge(const std::string& sourc, const std::string& de
  * Returns true if the graph is acyclic, and false otherwise.
  */
 
-bool Graph::isDAG() const {
+bool Graph::isDAG(SolverWorkspace& ws) const {
+    ws.fit(vertexSet.size());
+    std::fill(ws.visited.begin(), ws.visited.end(), false);
+    std::fill(ws.processing.begin(), ws.processing.end(), false);
     for (auto v : vertexSet) {
-        v.second->setVisited(false);
-        v.second->setProcessing(false);
-    }
-    for (auto v : vertexSet) {
-        if (! v.second->isVisited()) {
-            if ( ! dfsIsDAG(v.second) ) return false;
+        if (! ws.visited[v->getId()]) {
+            if ( ! dfsIsDAG(v, ws) ) return false;
         }
     }
     return true;
@@ -344,43 +295,42 @@ bool Graph::isDAG() const {
  * Returns false (not acyclic) if an edge to a vertex in the stack is found.
  */
 
-bool Graph::dfsIsDAG(Vertex *v) const {
-    v->setVisited(true);
-    v->setProcessing(true);
+bool Graph::dfsIsDAG(Vertex *v, SolverWorkspace& ws) const {
+    ws.visited[v->getId()] = true;
+    ws.processing[v->getId()] = true;
     for (auto e : v->getAdj()) {
         if(!e->checkActive()) continue;
         auto w = e->getDest();
-        if (w->isProcessing()) return false;
-        if (! w->isVisited()) {
-            if (! dfsIsDAG(w)) return false;
+        if (ws.processing[w->getId()]) return false;
+        if (! ws.visited[w->getId()]) {
+            if (! dfsIsDAG(w, ws)) return false;
         }
     }
-    v->setProcessing(false);
+    ws.processing[v->getId()] = false;
     return true;
 }
 
-void dfsVisit(Vertex* v, std::stack<std::string>& aux){
-    v->setVisited(true);
-    v->setProcessing(true);
+void dfsVisit(Vertex* v, std::stack<std::string>& aux, SolverWorkspace& ws){
+    ws.visited[v->getId()] = true;
+    ws.processing[v->getId()] = true;
     for(Edge* adj : v->getAdj()){
         if (adj->checkActive()) {
-            if(!adj->getDest()->isVisited()) dfsVisit(adj->getDest(), aux);
+            if(!ws.visited[adj->getDest()->getId()]) dfsVisit(adj->getDest(), aux, ws);
         }
     }
-    v->setProcessing(false);
+    ws.processing[v->getId()] = false;
     aux.push(v->getInfo());
 }
 
-std::vector<std::string> Graph::topSort() const {
+std::vector<std::string> Graph::topSort(SolverWorkspace& ws) const {
     std::vector<std::string> res;
     std::stack<std::string> aux;
+    ws.fit(vertexSet.size());
+    std::fill(ws.visited.begin(), ws.visited.end(), false);
+    std::fill(ws.processing.begin(), ws.processing.end(), false);
     for(auto v : vertexSet){
-        v.second->setVisited(false);
-        v.second->setProcessing(false);
-    }
-    for(const auto& v : vertexSet){
-        if(!v.second->isVisited()){
-            dfsVisit(v.second, aux);
+        if(!ws.visited[v->getId()]){
+            dfsVisit(v, aux, ws);
         }
     }
     while (!aux.empty()) {
@@ -391,23 +341,49 @@ std::vector<std::string> Graph::topSort() const {
 }
 
 void Graph::resetFlow() {
-    for(const auto& v: vertexSet){
-        for(Edge* e: v.second->getAdj()){
+    for(auto v: vertexSet){
+        for(Edge* e: v->getAdj()){
             e->setFlow(0);
         }
     }
 }
 
 Edge *Graph::findEdge(const std::string &source, const std::string &dest) const {
-    auto v = findVertex(source);
-    for(auto adj: v->getAdj()){
-        if(adj->getDest()->getInfo() == dest) return adj;
+    unsigned s = codes.find(source), d = codes.find(dest);
+    if (s == CodeTable::NONE || d == CodeTable::NONE) return nullptr;
+    return findEdge(s, d);
+}
+
+Edge *Graph::findEdge(unsigned source, unsigned dest) const {
+    for(auto adj: vertexSet[source]->getAdj()){
+        if(adj->getDest()->getId() == dest) return adj;
     }
     return nullptr;
 }
 
-Graph::~Graph() {
-    for (const auto& v: vertexSet) {
-        removeVertex(v.first);
+FlowGraph* Graph::getFlowGraph() {
+    if (packed == nullptr) packed = new FlowGraph(*this);
+    return packed;
+}
+
+void Graph::invalidateFlowGraph() {
+    delete packed;
+    packed = nullptr;
+}
+
+void Graph::clear() {
+    invalidateFlowGraph();
+    // every Edge is in exactly one outgoing list, so nothing has to be unlinked from the incoming lists
+    for (auto v: vertexSet) {
+        for (auto e: v->getAdj()) edgePool.destroy(e);
+        vertexPool.destroy(v);
     }
+    vertexSet.clear();
+    codes = CodeTable();
+    edgePool.reset();
+    vertexPool.reset();
+}
+
+Graph::~Graph() {
+    clear();
 }
\ No newline at end of file
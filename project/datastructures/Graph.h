@@ -7,11 +7,14 @@
 #include <limits>
 #include <algorithm>
 #include <unordered_map>
-#include <unordered_set>
 #include <list>
 #include <stack>
+#include "CodeTable.h"
+#include "Pool.h"
 
 class Edge;
+class FlowGraph;
+class SolverWorkspace;
 
 #define INF std::numeric_limits<double>::max()
 
@@ -32,139 +35,77 @@ public:
      * @param in The Vertex info.
      */
     explicit Vertex(std::string in);
-    /**
-     * \brief Less than operator to compare Vertex dists.
-     *
-     * @param vertex The Vertex to compare.
-     * @return True if this Vertex dist is lower than the dist of the given Vertex.
-     */
-    bool operator<(Vertex & vertex) const; // required by MutablePriorityQueue
-
     /**
      * \brief Gets the Vertex info.
      *
      * @return The Vertex info.
      */
-    std::string getInfo() const;
-    /**
-     * \brief Gets all outgoing Edge from the Vertex.
-     *
-     * @return All outgoing Edge from the Vertex.
-     */
-    std::vector<Edge*> getAdj() const;
-    /**
-     * \brief Gets the Vertex visited state.
-     *
-     * @return The Vertex visited state.
-     */
-    bool isVisited() const;
+    const std::string& getInfo() const;
     /**
-     * \brief Gets the Vertex processing state.
+     * \brief Gets the Vertex ID, the interned ID of its info in the Graph.
      *
-     * @return The Vertex processing state.
+     * @return The Vertex ID.
      */
-    bool isProcessing() const;
+    unsigned getId() const;
     /**
-     * \brief Gets the number of incoming Edge to the Vertex.
+     * \brief Sets the Vertex ID.
      *
-     * @return The number of incoming Edge to the Vertex.
+     * @param id The Vertex ID to set.
      */
-    unsigned int getIndegree() const;
+    void setId(unsigned id);
     /**
-     * \brief Gets the Vertex dist.
-     *
-     * @return The Vertex dist.
-     */
-    double getDist() const;
-    /**
-     * \brief Sets the Vertex dist.
-     *
-     * @param dist The Vertex dist to set.
-     */
-    void setDist(double dist);
-    /**
-     * \brief Gets the Vertex path.
+     * \brief Gets all outgoing Edge from the Vertex.
      *
-     * @return The Vertex path.
+     * @return All outgoing Edge from the Vertex.
      */
-    Edge *getPath() const;
+    const std::vector<Edge*>& getAdj() const;
     /**
      * \brief Gets all incoming Edge to the Vertex.
      *
      * @return All incoming Edge to the Vertex.
      */
-    std::vector<Edge *> getIncoming() const;
+    const std::vector<Edge *>& getIncoming() const;
     /**
      * \brief Sets the Vertex info.
      *
      * @param info The Vertex info to set.
      */
     void setInfo(std::string info);
-    /**
-     * \brief Sets the Vertex visited state.
-     *
-     * @param visited The Vertex visited state to set.
-     */
-    void setVisited(bool visited);
-    /**
-     * \brief Sets the Vertex processing state.
-     *
-     * @param processing The Vertex processing state to set.
-     */
-    void setProcessing(bool processing);
-    /**
-     * \brief Sets the Vertex indegree.
-     *
-     * @param indegree The Vertex indegree to set.
-     */
-    void setIndegree(unsigned int indegree);
-    /**
-     * \brief Sets the Vertex path.
-     *
-     * @param path The Vertex path to set.
-     */
-    void setPath(Edge *path);
     /**
      * \brief Creates a new Edge from this Vertex to the given Vertex with the given weight.
      *
      * @param dest The destination vertex of the new Edge.
      * @param w The weight of the new Edge.
+     * @param pool The arena of the Graph the new Edge is allocated from.
      * @return The new Edge.
      */
-    Edge * addEdge(Vertex *dest, double w);
+    Edge * addEdge(Vertex *dest, double w, Pool<Edge>& pool);
     /**
      * \brief Deletes all Edge from this Vertex to the Vertex with the given info.
      *
      * @param in The info of the destination Vertex of the Edge to delete.
+     * @param pool The arena of the Graph the Edge were allocated from.
      * @return True if deleted any Edge, false otherwise.
      */
-    bool removeEdge(const std::string& in);
+    bool removeEdge(const std::string& in, Pool<Edge>& pool);
     /**
      * \brief Deletes all Edge that are outgoing from this Vertex.
-     */
-    void removeOutgoingEdges();
-    /**
-     * \brief Gets the Vertex paths.
      *
-     * @return The Vertex paths.
-     */
-    std::unordered_set<int> getPaths();
-    /**
-     * \brief Adds a new path to paths.
+     * @param pool The arena of the Graph the Edge were allocated from.
      *
-     * @param p The new path to add.
+     * \par Complexity
+     * O(d) in which d is the outdegree of the Vertex.
      */
-    void addPath(int p);
+    void removeOutgoingEdges(Pool<Edge>& pool);
     /**
-     * \brief Removes the given path from paths.
+     * \brief Deletes all Edge that are incoming to this Vertex.
      *
-     * @param p The path to remove.
-     */
-    void removePath(int p);
-    /**
-     * \brief Removes all path from paths.
+     * @param pool The arena of the Graph the Edge were allocated from.
+     *
+     * \par Complexity
+     * O(d) in which d is the indegree of the Vertex.
      */
-    void resetPath();
+    void removeIncomingEdges(Pool<Edge>& pool);
     /**
      * \brief Sets the Vertex active state to false.
      */
@@ -180,26 +121,23 @@ public:
      */
     bool checkActive();
     /**
-     * \brief Removes incoming Edge from the Vertex.
+     * \brief Unlinks the given Edge from the outgoing list of its origin and the incoming list of its destination and
+     * deletes it.
      *
      * @param edge The Edge to remove.
+     * @param pool The arena of the Graph the Edge was allocated from.
+     *
+     * \par Complexity
+     * O(1).
      */
-    void deleteEdge(Edge *edge);
-    unsigned queueIndex = 0;
+    static void deleteEdge(Edge *edge, Pool<Edge>& pool);
 protected:
     std::string info;                // info node
+    unsigned id = 0;
     std::vector<Edge *> adj;  // outgoing edges
 
-    // auxiliary fields
-    bool visited = false; // used by DFS, BFS, Prim ...
-    bool processing = false; // used by isDAG (in addition to the visited attribute)
-    unsigned int indegree = 0; // used by topsort
-    double dist = 0;
-    Edge *path = nullptr;
-
     std::vector<Edge *> incoming; // incoming edges
 
-    std::unordered_set<int> paths;
     bool isActive = true;
 
 };
@@ -222,6 +160,18 @@ public:
      * @param w The Edge weight.
      */
     Edge(Vertex *orig, Vertex *dest, double w);
+    /**
+     * \brief Gets the Edge ID, a dense index assigned when the Graph is packed into a FlowGraph.
+     *
+     * @return The Edge ID.
+     */
+    unsigned getId() const;
+    /**
+     * \brief Sets the Edge ID.
+     *
+     * @param id The Edge ID to set.
+     */
+    void setId(unsigned id);
     /**
      * \brief Gets the Edge destination Vertex.
      *
@@ -270,35 +220,6 @@ public:
      * @param weight The Edge weight to set.
      */
     void setWeight(double weight);
-    /**
-     * \brief Gets the Edge paths.
-     *
-     * @return The Edge paths.
-     */
-    std::unordered_set<int> getPaths();
-    /**
-     * \brief Adds a new path to paths.
-     *
-     * @param p The new path to add.
-     */
-    void addPath(int p);
-    /**
-     * \brief Removes the given path from paths.
-     *
-     * @param p The path to remove.
-     */
-    void removePath(int p);
-    /**
-     * \brief Removes all path from paths.
-     */
-    void resetPath();
-    /**
-     * \brief Checks if the given path is in paths.
-     *
-     * @param p The path to check.
-     * @return True if the given path is in paths, false otherwise.
-     */
-    bool hasPath(int p);
     /**
      * \brief Sets the Edge active state to false.
      */
@@ -313,18 +234,6 @@ public:
      * @return The Edge active state.
      */
     bool checkActive() const;
-    /**
-     * \brief Gets the Edge visited state.
-     *
-     * @return The Edge visited state.
-     */
-    bool checkVisited() const;
-    /**
-     * \brief Sets the Edge visited state to the given state.
-     *
-     * @param newVisited The state to set the Edge visited state.
-     */
-    void setVisited(bool newVisited);
 protected:
     Vertex * dest; // destination vertex
     double weight; // edge weight, can also be used for capacity
@@ -332,11 +241,15 @@ protected:
     // used for bidirectional edges
     Vertex *orig;
     Edge *reverse = nullptr;
+    unsigned id = 0;
 
     double flow = 0; // for flow-related problems
-    std::unordered_set<int> paths;
     bool isActive = true;
-    bool visited = false;
+
+    // positions of the edge in orig->adj and dest->incoming, kept up to date by Vertex
+    unsigned adjSlot = 0;
+    unsigned incomingSlot = 0;
+    friend class Vertex;
 };
 
 /********************** Graph  ****************************/
@@ -350,9 +263,16 @@ protected:
 class Graph {
 public:
     /**
-     * \brief Graph constructor.
+     * \brief Graph destructor.
      */
     ~Graph();
+    /**
+     * \brief Removes every Vertex and Edge from this Graph, keeping the arena blocks for the next load.
+     *
+     * \par Complexity
+     * O(V + E) in which V is the number of vertex and E the number of edges of the Graph.
+     */
+    void clear();
     /**
      * \brief Auxiliary function to find a Vertex with the given info.
      *
@@ -360,6 +280,27 @@ public:
      * @return The Vertex with the given info.
      */
     Vertex *findVertex(const std::string &in) const;
+    /**
+     * \brief Auxiliary function to find a Vertex with the given ID.
+     *
+     * @param id The ID of the Vertex to find.
+     * @return The Vertex with the given ID.
+     */
+    Vertex *findVertex(unsigned id) const;
+    /**
+     * \brief Gets the ID of the Vertex with the given info.
+     *
+     * @param in The info of the Vertex.
+     * @return The ID of the Vertex or CodeTable::NONE if there is no such Vertex.
+     */
+    unsigned findVertexId(const std::string &in) const;
+    /**
+     * \brief Gets the info of the Vertex with the given ID without copying it.
+     *
+     * @param id The ID of the Vertex.
+     * @return The info of the Vertex.
+     */
+    const std::string &getInfo(unsigned id) const;
     /**
      * \brief Auxiliary function to find an Edge with the given origin and destination Vertex.
      *
@@ -368,6 +309,14 @@ public:
      * @return The Edge with the given origin and destination Vertex.
      */
     Edge *findEdge(const std::string &source, const std::string &dest) const;
+    /**
+     * \brief Auxiliary function to find an Edge with the given origin and destination Vertex IDs.
+     *
+     * @param source The ID of the Edge's origin Vertex.
+     * @param dest The ID of the Edge's destination Vertex.
+     * @return The Edge with the given origin and destination Vertex.
+     */
+    Edge *findEdge(unsigned source, unsigned dest) const;
     /**
      * \brief Adds a new Vertex with the given info to this Graph.
      *
@@ -378,8 +327,13 @@ public:
     /**
      * \brief Deletes the Vertex with the given info from this Graph.
      *
+     * The last Vertex of the VertexSet takes the ID of the deleted Vertex, so IDs stay dense.
+     *
      * @param in The info of the Vertex to delete.
      * @return True if Vertex was deleted, false otherwise.
+     *
+     * \par Complexity
+     * O(d) average in which d is the number of Edge incident to the Vertex.
      */
     bool removeVertex(const std::string &in);
     /**
@@ -390,7 +344,7 @@ public:
      * @param w The weight of the Edge to add.
      * @return True if Edge was added, false otherwise.
      */
-    bool addEdge(const std::string &sourc, const std::string &dest, double w) const;
+    bool addEdge(const std::string &sourc, const std::string &dest, double w);
     /**
      * \brief Adds two new Edge with the given weight from the Vertex with the given origin info to the Vertex with the given destination info and vice-versa to this Graph.
      *
@@ -399,7 +353,7 @@ public:
      * @param w The weight of the two Edge to add.
      * @return True if both Edge were added, false otherwise.
      */
-    bool addBidirectionalEdge(const std::string &sourc, const std::string &dest, double w) const;
+    bool addBidirectionalEdge(const std::string &sourc, const std::string &dest, double w);
     /**
      * \brief Gets the number of Vertex in this Graph.
      *
@@ -407,36 +361,57 @@ public:
      */
     int getNumVertex() const;
     /**
-     * \brief Gets the VertexSet of this Graph.
+     * \brief Gets the VertexSet of this Graph, indexed by Vertex ID.
      *
      * @return The VertexSet of this Graph.
      */
-    std::unordered_map<std::string, Vertex*> getVertexSet() const;
+    const std::vector<Vertex*>& getVertexSet() const;
     /**
      * \brief Checks if this Graph is a DAG (Directed Acyclic Graph).
      *
+     * @param ws The workspace that keeps the DFS marks.
      * @return True if this Graph is a DAG, false otherwise.
      */
-    bool isDAG() const;
+    bool isDAG(SolverWorkspace& ws) const;
     /**
      * \brief Auxiliary dfs function to check if this Graph is a DAG (Directed Acyclic Graph) from the given starting Vertex.
      *
      * @param v The starting Vertex.
+     * @param ws The workspace that keeps the DFS marks.
      * @return True if this Graph is a DAG, false otherwise.
      */
-    bool dfsIsDAG(Vertex *v) const;
+    bool dfsIsDAG(Vertex *v, SolverWorkspace& ws) const;
     /**
      * \brief Sorts all Vertex in this Graph in topological order.
      *
+     * @param ws The workspace that keeps the DFS marks.
      * @return All Vertex in this Graph in topological order.
      */
-    std::vector<std::string> topSort() const;
+    std::vector<std::string> topSort(SolverWorkspace& ws) const;
     /**
      * \brief Resets all Edge's flow of this Graph to 0.
      */
     void resetFlow();
+    /**
+     * \brief Gets the packed FlowGraph of this Graph, building it if the Graph changed since it was last built.
+     *
+     * @return The FlowGraph of this Graph.
+     *
+     * \par Complexity
+     * O(V + E) when the FlowGraph has to be rebuilt, O(1) otherwise.
+     */
+    FlowGraph* getFlowGraph();
 protected:
-    std::unordered_map<std::string, Vertex *> vertexSet;    // vertex set
+    std::vector<Vertex *> vertexSet;    // vertex set, indexed by vertex ID
+    CodeTable codes;                    // vertex info -> vertex ID
+    FlowGraph* packed = nullptr;  // CSR cache, dropped whenever a Vertex or Edge is added or removed
+    Pool<Vertex> vertexPool;      // storage of every Vertex of the Graph
+    Pool<Edge> edgePool;          // storage of every Edge of the Graph
+
+    /**
+     * \brief Discards the packed FlowGraph after a structural change.
+     */
+    void invalidateFlowGraph();
 };
 
 
@@ -0,0 +1,159 @@
+#ifndef WATERSUPPLYMANAGER_INDEXEDHEAP_H
+#define WATERSUPPLYMANAGER_INDEXEDHEAP_H
+
+#include <vector>
+
+/**
+ * \class IndexedHeap
+ * \brief A min d-ary heap of element IDs, such as Vertex IDs, that supports decreasing the key of an element.
+ *
+ * Every entry stores its key next to its ID, so sifting compares contiguous memory instead of reading the keys from
+ * another array. The position of each element in the heap is kept in an external array indexed by ID, such as the
+ * queueIndex array of a SolverWorkspace, so any number of heaps can work over the same elements with different arrays.
+ * A wider heap is shallower: inserting and decreasing keys move fewer entries, extracting compares more children.
+ *
+ * @tparam Key The type of the keys, compared with <.
+ * @tparam D The number of children of each node.
+ */
+template <typename Key, unsigned D = 4>
+class IndexedHeap {
+    static_assert(D >= 2, "a heap node needs at least two children");
+    struct Entry {
+        Key key;
+        unsigned id;
+    };
+    std::vector<Entry> heap;
+    std::vector<unsigned>& index;
+    /**
+     * \brief Moves the given entry up from the given position until its parent has a smaller key.
+     *
+     * @param i The position the entry starts at.
+     * @param entry The entry to place.
+     *
+     * @par Complexity
+     * O(log_D n), in which n is the number of elements in the heap.
+     */
+    void siftUp(unsigned i, Entry entry);
+    /**
+     * \brief Moves the given entry down from the given position until none of its children has a smaller key.
+     *
+     * @param i The position the entry starts at.
+     * @param entry The entry to place.
+     *
+     * @par Complexity
+     * O(D log_D n), in which n is the number of elements in the heap.
+     */
+    void siftDown(unsigned i, Entry entry);
+    /**
+     * \brief Places the given entry at the given position and records the position.
+     *
+     * @param i The position in the heap.
+     * @param entry The entry to place.
+     */
+    void place(unsigned i, const Entry& entry) {
+        heap[i] = entry;
+        index[entry.id] = i;
+    }
+public:
+    /**
+     * \brief Creates a new empty heap.
+     *
+     * @param index The array where the position of each element in the heap is kept.
+     */
+    explicit IndexedHeap(std::vector<unsigned>& index) : index(index) {}
+    /**
+     * \brief Inserts a new element into the heap.
+     *
+     * @param x The element to be inserted, not in the heap.
+     * @param key The key of the element.
+     *
+     * @par Complexity
+     * O(log_D n), in which n is the number of elements in the heap.
+     */
+    void insert(unsigned x, Key key);
+    /**
+     * \brief Extracts the element with the smallest key, removing it from the heap.
+     *
+     * @return The element with the smallest key.
+     *
+     * @par Complexity
+     * O(D log_D n), in which n is the number of elements in the heap.
+     */
+    unsigned extractMin();
+    /**
+     * \brief Lowers the key of an element in the heap, moving it up in priority.
+     *
+     * @param x The element whose key is to be decreased.
+     * @param key The new key, not greater than the current one.
+     *
+     * @par Complexity
+     * O(log_D n), in which n is the number of elements in the heap.
+     */
+    void decreaseKey(unsigned x, Key key);
+    /**
+     * \brief Gets the smallest key in the heap, which must not be empty.
+     *
+     * @return The key extractMin() would return the element of.
+     */
+    const Key& minKey() const { return heap.front().key; }
+    /**
+     * \brief Checks whether the heap is empty or not.
+     *
+     * @return True if the heap doesn't have any elements, false otherwise.
+     */
+    bool empty() const { return heap.empty(); }
+    /**
+     * \brief Removes every element, keeping the memory for the next search.
+     */
+    void clear() { heap.clear(); }
+};
+
+template <typename Key, unsigned D>
+void IndexedHeap<Key, D>::insert(unsigned x, Key key) {
+    heap.push_back({key, x});
+    siftUp(heap.size() - 1, {key, x});
+}
+
+template <typename Key, unsigned D>
+unsigned IndexedHeap<Key, D>::extractMin() {
+    unsigned x = heap.front().id;
+    Entry last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) siftDown(0, last);
+    return x;
+}
+
+template <typename Key, unsigned D>
+void IndexedHeap<Key, D>::decreaseKey(unsigned x, Key key) {
+    siftUp(index[x], {key, x});
+}
+
+template <typename Key, unsigned D>
+void IndexedHeap<Key, D>::siftUp(unsigned i, Entry entry) {
+    while (i > 0) {
+        unsigned p = (i - 1) / D;
+        if (!(entry.key < heap[p].key)) break;
+        place(i, heap[p]);
+        i = p;
+    }
+    place(i, entry);
+}
+
+template <typename Key, unsigned D>
+void IndexedHeap<Key, D>::siftDown(unsigned i, Entry entry) {
+    auto n = (unsigned) heap.size();
+    while (true) {
+        unsigned first = i * D + 1;
+        if (first >= n) break;
+        unsigned last = first + D < n ? first + D : n, best = first;
+        for (unsigned k = first + 1; k < last; k++) {
+            if (heap[k].key < heap[best].key) best = k;
+        }
+        if (!(heap[best].key < entry.key)) break;
+        place(i, heap[best]);
+        i = best;
+    }
+    place(i, entry);
+}
+
+#endif //WATERSUPPLYMANAGER_INDEXEDHEAP_H
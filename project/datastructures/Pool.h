@@ -0,0 +1,94 @@
+#ifndef WATERSUPPLYMANAGER_POOL_H
+#define WATERSUPPLYMANAGER_POOL_H
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+/**
+ * \class Pool
+ * \brief An arena that allocates objects of type T from large contiguous blocks.
+ *
+ * Objects are bump-allocated from the current block; destroyed objects are kept in a free list and reused by later
+ * allocations. reset() hands every block back to the arena at once without returning memory to the heap, so a Graph
+ * can be cleared and reloaded into the same blocks.
+ *
+ * @tparam T The type of the objects to allocate.
+ */
+template <class T>
+class Pool {
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    static constexpr std::size_t BLOCK_SIZE = 1024;
+
+    std::vector<Slot*> blocks;
+    std::size_t block = 0;  // block currently being bump-allocated
+    std::size_t used = 0;   // slots already handed out from that block
+    Slot* freeList = nullptr;
+public:
+    Pool() = default;
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    /**
+     * \brief Frees every block. Objects still alive are not destroyed.
+     */
+    ~Pool() {
+        for (Slot* b: blocks) delete[] b;
+    }
+    /**
+     * \brief Constructs a new object in the arena.
+     *
+     * @param args The arguments forwarded to the constructor of T.
+     * @return The new object.
+     *
+     * \par Complexity
+     * O(1) amortized.
+     */
+    template <class... Args>
+    T* create(Args&&... args) {
+        Slot* slot;
+        if (freeList != nullptr) {
+            slot = freeList;
+            freeList = freeList->next;
+        } else {
+            if (block == blocks.size()) blocks.push_back(new Slot[BLOCK_SIZE]);
+            slot = &blocks[block][used];
+            if (++used == BLOCK_SIZE) {
+                block++;
+                used = 0;
+            }
+        }
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+    /**
+     * \brief Destroys an object created by this arena and keeps its slot for reuse.
+     *
+     * @param obj The object to destroy.
+     *
+     * \par Complexity
+     * O(1) plus the cost of the destructor of T.
+     */
+    void destroy(T* obj) {
+        obj->~T();
+        Slot* slot = reinterpret_cast<Slot*>(obj);
+        slot->next = freeList;
+        freeList = slot;
+    }
+    /**
+     * \brief Makes every slot of the arena available again, keeping the blocks for the next allocations.
+     * All objects must have been destroyed before.
+     *
+     * \par Complexity
+     * O(1).
+     */
+    void reset() {
+        block = 0;
+        used = 0;
+        freeList = nullptr;
+    }
+};
+
+#endif //WATERSUPPLYMANAGER_POOL_H
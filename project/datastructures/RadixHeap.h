@@ -0,0 +1,142 @@
+#ifndef WATERSUPPLYMANAGER_RADIXHEAP_H
+#define WATERSUPPLYMANAGER_RADIXHEAP_H
+
+#include <vector>
+#include <type_traits>
+
+/**
+ * \class RadixHeap
+ * \brief A monotone min priority queue of element IDs with unsigned integer keys, for Dijkstra over integer costs.
+ *
+ * Keys can never be smaller than the last key extracted, which holds in Dijkstra when no cost is negative. Bucket b
+ * holds the elements whose key first differs from the last key extracted at bit b - 1, bucket 0 those with the same
+ * key, so inserting and decreasing a key are O(1) and an element moves to a lower bucket at most once per bit. The
+ * position of each element is kept in an external array indexed by ID, such as the queueIndex array of a
+ * SolverWorkspace, as its bucket and its slot in the bucket.
+ *
+ * @tparam Key The unsigned integer type of the keys.
+ */
+template <typename Key = unsigned long long>
+class RadixHeap {
+    static_assert(std::is_unsigned<Key>::value, "radix heap keys must be unsigned integers");
+    static constexpr unsigned BUCKETS = sizeof(Key) * 8 + 1;
+    static constexpr unsigned SLOT_BITS = 24;  // an index holds (bucket << SLOT_BITS) | slot
+    struct Entry {
+        Key key;
+        unsigned id;
+    };
+    std::vector<Entry> buckets[BUCKETS];
+    std::vector<unsigned>& index;
+    Key last = 0;
+    unsigned count = 0;
+    /**
+     * \brief Gets the bucket of the given key, the number of bits up to the highest one in which it differs from the
+     * last key extracted.
+     *
+     * @param key The key.
+     * @return The bucket of the key.
+     */
+    unsigned bucketOf(Key key) const {
+        Key diff = key ^ last;
+#if defined(__GNUC__)
+        return diff == 0 ? 0 : sizeof(unsigned long long) * 8 - __builtin_clzll(diff);
+#else
+        unsigned b = 0;
+        for (; diff != 0; diff >>= 1) b++;
+        return b;
+#endif
+    }
+    /**
+     * \brief Appends the given entry to its bucket and records its position.
+     *
+     * @param entry The entry to store.
+     */
+    void place(const Entry& entry) {
+        unsigned b = bucketOf(entry.key);
+        index[entry.id] = (b << SLOT_BITS) | (unsigned) buckets[b].size();
+        buckets[b].push_back(entry);
+    }
+public:
+    /**
+     * \brief Creates a new empty heap.
+     *
+     * @param index The array where the position of each element in the heap is kept.
+     */
+    explicit RadixHeap(std::vector<unsigned>& index) : index(index) {}
+    /**
+     * \brief Inserts a new element into the heap.
+     *
+     * @param x The element to be inserted, not in the heap.
+     * @param key The key of the element, not smaller than the last key extracted.
+     *
+     * @par Complexity
+     * O(1).
+     */
+    void insert(unsigned x, Key key) {
+        place({key, x});
+        count++;
+    }
+    /**
+     * \brief Lowers the key of an element in the heap.
+     *
+     * @param x The element whose key is to be decreased.
+     * @param key The new key, not smaller than the last key extracted.
+     *
+     * @par Complexity
+     * O(1).
+     */
+    void decreaseKey(unsigned x, Key key);
+    /**
+     * \brief Extracts an element with the smallest key, removing it from the heap.
+     *
+     * @return An element with the smallest key.
+     *
+     * @par Complexity
+     * O(B) amortized, in which B is the number of bits of the keys.
+     */
+    unsigned extractMin();
+    /**
+     * \brief Gets the last key extracted.
+     *
+     * @return The key of the element extractMin() returned last, 0 before the first extraction.
+     */
+    Key lastKey() const { return last; }
+    /**
+     * \brief Checks whether the heap is empty or not.
+     *
+     * @return True if the heap doesn't have any elements, false otherwise.
+     */
+    bool empty() const { return count == 0; }
+};
+
+template <typename Key>
+void RadixHeap<Key>::decreaseKey(unsigned x, Key key) {
+    std::vector<Entry>& bucket = buckets[index[x] >> SLOT_BITS];
+    unsigned slot = index[x] & ((1u << SLOT_BITS) - 1);
+    if (slot + 1 != bucket.size()) {
+        bucket[slot] = bucket.back();
+        index[bucket[slot].id] = (index[x] & ~((1u << SLOT_BITS) - 1)) | slot;
+    }
+    bucket.pop_back();
+    place({key, x});
+}
+
+template <typename Key>
+unsigned RadixHeap<Key>::extractMin() {
+    if (buckets[0].empty()) {
+        // the smallest key of the first non-empty bucket becomes the last key, its entries all move to lower buckets
+        unsigned b = 1;
+        while (buckets[b].empty()) b++;
+        Key min = buckets[b].front().key;
+        for (const Entry& entry : buckets[b]) if (entry.key < min) min = entry.key;
+        last = min;
+        for (const Entry& entry : buckets[b]) place(entry);
+        buckets[b].clear();
+    }
+    unsigned x = buckets[0].back().id;
+    buckets[0].pop_back();
+    count--;
+    return x;
+}
+
+#endif //WATERSUPPLYMANAGER_RADIXHEAP_H
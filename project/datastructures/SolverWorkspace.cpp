@@ -0,0 +1,50 @@
+#include "SolverWorkspace.h"
+
+void SolverWorkspace::fit(unsigned numVertex) {
+    visited.resize(numVertex);
+    processing.resize(numVertex);
+    dist.resize(numVertex);
+    path.resize(numVertex);
+    indegree.resize(numVertex);
+    queueIndex.resize(numVertex);
+    frontier.resize(numVertex);
+    level.resize(numVertex);
+    currentArc.resize(numVertex);
+    excess.resize(numVertex);
+    labelCount.resize(2 * numVertex + 1);
+    active.resize(numVertex);
+    tree.resize(numVertex);
+    treeParent.resize(numVertex);
+    potential.resize(numVertex);
+    mark.resize(numVertex);
+}
+
+void SolverWorkspace::attach(const FlowGraph& g) {
+    if (graph != &g || tree.size() != g.getNumVertex()) treesValid = false;
+    if (graph != &g || cost.size() != g.getNumEdge()) basisValid = false;
+    graph = &g;
+    fit(g.getNumVertex());
+    vertexActive.resize(g.getNumVertex());
+    capacity.resize(g.getNumEdge());
+    flow.resize(g.getNumEdge());
+    edgeActive.resize(g.getNumEdge());
+    cost.resize(g.getNumEdge());
+}
+
+void SolverWorkspace::load() {
+    for (unsigned v = 0; v < graph->getNumVertex(); v++) {
+        vertexActive[v] = graph->getVertex(v)->checkActive();
+    }
+    for (unsigned e = 0; e < graph->getNumEdge(); e++) {
+        Edge* edge = graph->getEdge(e);
+        capacity[e] = edge->getWeight();
+        flow[e] = edge->getFlow();
+        edgeActive[e] = edge->checkActive();
+    }
+}
+
+void SolverWorkspace::store() const {
+    for (unsigned e = 0; e < graph->getNumEdge(); e++) {
+        graph->getEdge(e)->setFlow(flow[e]);
+    }
+}
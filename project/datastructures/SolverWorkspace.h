@@ -0,0 +1,165 @@
+#ifndef WATERSUPPLYMANAGER_SOLVERWORKSPACE_H
+#define WATERSUPPLYMANAGER_SOLVERWORKSPACE_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "FlowGraph.h"
+
+/**
+ * \class SolverWorkspace
+ * \brief The per-run state of the graph algorithms, stored as one array per field indexed by Vertex or Edge ID.
+ *
+ * The Graph and its FlowGraph only describe the topology; every search mark, distance, parent and flow an algorithm
+ * needs lives in a workspace. Two algorithms with different workspaces can therefore run over the same Graph at the
+ * same time, as long as only one of them calls store().
+ */
+class SolverWorkspace {
+private:
+    const FlowGraph* graph = nullptr;
+    std::vector<unsigned> mark;  // epoch in which each vertex was last labeled
+    unsigned epoch = 0;
+public:
+    /**
+     * \brief The value of path for vertices that were not reached.
+     */
+    static constexpr unsigned NONE = std::numeric_limits<unsigned>::max();
+    /**
+     * \brief The work done by one thread of a parallel algorithm.
+     */
+    struct ThreadWork {
+        unsigned long pushes = 0;
+        unsigned long relabels = 0;
+        double seconds = 0;  // time spent working, without the time waiting for the other threads
+    };
+
+    /*** Vertex scratch ***/
+    std::vector<char> visited;
+    std::vector<char> processing;     // on the DFS stack
+    std::vector<double> dist;
+    std::vector<unsigned> path;       // arc (or Edge ID for Graph searches) the vertex was reached through
+    std::vector<unsigned> indegree;
+    std::vector<unsigned> queueIndex; // position in the heap of a Dijkstra search
+    std::vector<unsigned> frontier;   // BFS queue buffer, one slot per vertex
+    std::vector<unsigned> level;      // BFS distance from the source in the level graph
+    std::vector<unsigned> currentArc; // next arc to try in a blocking flow search or a discharge
+    std::vector<double> excess;       // inflow - outflow of each vertex in a preflow
+    std::vector<unsigned> labelCount; // number of vertices with each push-relabel height, sized 2V
+    std::vector<unsigned> active;     // FIFO ring of the push-relabel vertices with excess
+
+    /*** Network state ***/
+    std::vector<double> capacity;
+    std::vector<double> flow;
+    std::vector<char> edgeActive;
+    std::vector<char> vertexActive;
+
+    /*** Min-cost flow ***/
+    std::vector<long long> cost;      // cost of one unit of flow through each Edge, integer so sums of costs are exact
+    std::vector<long long> potential; // Johnson potential of each vertex, keeps the reduced costs non-negative
+    std::vector<signed char> basis;   // network simplex state of each arc of the last basis, kept between runs
+    bool basisValid = false;          // false until a network simplex run leaves a basis for the attached FlowGraph
+
+    /*** Search trees, kept between runs ***/
+    /**
+     * \brief The search tree a vertex belongs to in the Boykov-Kolmogorov engine.
+     */
+    enum TreeSide : char { FREE, SOURCE_TREE, SINK_TREE };
+    std::vector<char> tree;           // TreeSide of each vertex
+    std::vector<unsigned> treeParent; // (edge ID << 1) | 1 if the Edge goes from the vertex to its parent, NONE at the roots
+    bool treesValid = false;          // false until a run builds the trees for the attached FlowGraph
+
+    /*** Parallel runs ***/
+    unsigned threads = 0;                // number of threads of the parallel algorithms, 0 for one per core
+    std::vector<ThreadWork> threadWork;  // work done by each thread in the last parallel run
+
+    /**
+     * \brief Sizes the vertex scratch arrays for a Graph with the given number of Vertex.
+     *
+     * @param numVertex The number of Vertex.
+     *
+     * \par Complexity
+     * O(V) in which V is the number of vertex.
+     */
+    void fit(unsigned numVertex);
+    /**
+     * \brief Binds this workspace to the given FlowGraph and sizes every array for it. The search trees and the
+     * network simplex basis of the previous runs are dropped if the FlowGraph is a different one.
+     *
+     * @param g The FlowGraph the next runs will use.
+     *
+     * \par Complexity
+     * O(V + E) in which V is the number of vertex and E the number of edges of the FlowGraph.
+     */
+    void attach(const FlowGraph& g);
+    /**
+     * \brief Copies the current capacity, flow and active state of every Vertex and Edge of the attached FlowGraph.
+     *
+     * \par Complexity
+     * O(V + E) in which V is the number of vertex and E the number of edges of the FlowGraph.
+     */
+    void load();
+    /**
+     * \brief Writes the flow of every Edge back to the Graph.
+     *
+     * \par Complexity
+     * O(E) in which E is the number of edges of the FlowGraph.
+     */
+    void store() const;
+    /**
+     * \brief Starts a new search, unlabeling every vertex without touching the labels array.
+     *
+     * \par Complexity
+     * O(1) amortized, O(V) once every 2³² searches when the epoch counter wraps around.
+     */
+    void newSearch() {
+        if (++epoch == 0) {
+            std::fill(mark.begin(), mark.end(), 0);
+            epoch = 1;
+        }
+    }
+    /**
+     * \brief Checks if the given vertex was labeled in the current search.
+     *
+     * @param v The Vertex ID.
+     * @return True if the vertex was labeled since the last newSearch(), false otherwise.
+     */
+    bool isLabeled(unsigned v) const { return mark[v] == epoch; }
+    /**
+     * \brief Labels the given vertex in the current search.
+     *
+     * @param v The Vertex ID.
+     */
+    void label(unsigned v) { mark[v] = epoch; }
+    /**
+     * \brief Gets the FlowGraph this workspace is attached to.
+     *
+     * @return The attached FlowGraph.
+     */
+    const FlowGraph& getGraph() const { return *graph; }
+    /**
+     * \brief Gets the residual capacity of the given arc.
+     *
+     * @param a The arc index.
+     * @return Capacity - flow for forward arcs and flow for reverse arcs.
+     */
+    double residual(unsigned a) const {
+        unsigned e = graph->edgeOf(a);
+        return graph->isForward(a) ? capacity[e] - flow[e] : flow[e];
+    }
+    /**
+     * \brief Checks if the given arc can be used, i.e. its Edge and the Vertex it reaches are both active.
+     *
+     * @param a The arc index.
+     * @return True if the arc can be used, false otherwise.
+     */
+    bool isUsable(unsigned a) const { return edgeActive[graph->edgeOf(a)] && vertexActive[graph->head(a)]; }
+    /**
+     * \brief Sends the given amount of flow through the given arc.
+     *
+     * @param a The arc index.
+     * @param amount The amount of flow to send.
+     */
+    void push(unsigned a, double amount) { flow[graph->edgeOf(a)] += graph->isForward(a) ? amount : -amount; }
+};
+
+#endif //WATERSUPPLYMANAGER_SOLVERWORKSPACE_H